@@ -0,0 +1,215 @@
+// reduce_ops.h 的带宽扫描：数组从 4 KB（L1 内）翻倍到 4 GB（或 -M 指定的上限），
+// 对每种操作取最短耗时，输出 GB/s
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include <omp.h>
+#include "reduce_ops.h"
+
+namespace {
+
+// 每个尺寸至少跑这么多次、这么长时间，取最短的一次
+const int kMinReps = 3;
+const double kMinSeconds = 0.2;
+// 不超过这个字节数的尺寸与串行结果对拍
+const size_t kCheckBytes = size_t(64) << 20;
+// 分段求和的平均段长
+const size_t kSegLen = 256;
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [OPTIONS]\n";
+    std::cout << "Options:\n";
+    std::cout << "  -M <MB>       Largest array size in MB (default: 4096, capped at half of RAM)\n";
+    std::cout << "  -o <ops>      Comma separated ops: sum,sumsq,min,max,argmax,segsum,scan (default: all)\n";
+    std::cout << "  -h            Show this help message\n";
+}
+
+// 并行填充 [-1, 1) 的伪随机数，避免在 GB 级数组上用 <random> 等太久
+void fill(float* a, size_t n) {
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < (long long)n; i++) {
+        unsigned long long z = (unsigned long long)i * 0x9E3779B97F4A7C15ULL + 20250928;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+        a[i] = (float)((z >> 40) * (1.0 / (1ULL << 23)) - 1.0);
+    }
+}
+
+template <typename F>
+double best_time(F f) {
+    double best = 1e30, total = 0.0;
+    for (int rep = 0; rep < kMinReps || total < kMinSeconds; rep++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto end = std::chrono::high_resolution_clock::now();
+        double t = std::chrono::duration<double>(end - start).count();
+        best = std::min(best, t);
+        total += t;
+    }
+    return best;
+}
+
+bool selected(const std::string& ops, const char* op) {
+    if (ops == "all") {
+        return true;
+    }
+    std::string list = "," + ops + ",";
+    return list.find(std::string(",") + op + ",") != std::string::npos;
+}
+
+std::string human(size_t bytes) {
+    const char* unit[] = {"B", "KB", "MB", "GB"};
+    int u = 0;
+    double v = (double)bytes;
+    while (v >= 1024 && u < 3) {
+        v /= 1024;
+        u++;
+    }
+    std::ostringstream os;
+    os << v << " " << unit[u];
+    return os.str();
+}
+
+void report(size_t bytes, const char* op, double seconds, double traffic, bool ok) {
+    std::cout << std::setw(10) << human(bytes) << std::setw(8) << op
+              << std::setw(12) << std::setprecision(4) << seconds * 1e6 << " us"
+              << std::setw(10) << std::setprecision(4) << traffic / seconds / 1e9 << " GB/s"
+              << (ok ? "" : "  Result incorrect!") << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t max_bytes = size_t(4) << 30;
+    std::string ops = "all";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-M") == 0 && i + 1 < argc) {
+            long long mb = atoll(argv[++i]);
+            if (mb <= 0) {
+                std::cerr << "Error: -M must be positive!\n";
+                return 1;
+            }
+            max_bytes = (size_t)mb << 20;
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            ops = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Error: Unknown option " << argv[i] << "\n";
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // 内存不够时自动缩小上限，避免测到 swap
+    const size_t ram = (size_t)sysconf(_SC_PHYS_PAGES) * (size_t)sysconf(_SC_PAGE_SIZE);
+    if (max_bytes > ram / 2) {
+        max_bytes = ram / 2;
+        std::cout << "max size capped at " << human(max_bytes) << " (half of RAM)" << std::endl;
+    }
+    const size_t max_n = max_bytes / sizeof(float);
+
+    float* a = (float*)aligned_alloc(64, ((max_n * sizeof(float) + 63) / 64) * 64);
+    fill(a, max_n);
+    // 段长在 [1, 2 * kSegLen) 之间变化的分段
+    std::vector<long long> offsets(1, 0);
+    std::vector<double> seg_out;
+    std::vector<float> scan_buf;
+
+    std::cout << "threads: " << omp_get_max_threads() << std::endl;
+    for (size_t bytes = 4096; bytes <= max_bytes; bytes *= 2) {
+        const size_t n = bytes / sizeof(float);
+        const bool check = bytes <= kCheckBytes;
+        double ref_sum = 0.0, ref_sq = 0.0, abs_sum = 0.0, prefix_abs = 0.0;
+        float ref_min = a[0], ref_max = a[0];
+        size_t ref_arg = 0;
+        if (check) {
+            for (size_t i = 0; i < n; i++) {
+                ref_sum += a[i];
+                abs_sum += std::fabs(a[i]);
+                prefix_abs += std::fabs(ref_sum);
+                ref_sq += (double)a[i] * a[i];
+                ref_min = std::min(ref_min, a[i]);
+                if (a[i] > ref_max) {
+                    ref_max = a[i];
+                    ref_arg = i;
+                }
+            }
+        }
+        // 块内用 float 累加，误差上界约为 eps * sum(|x|)
+        const double eps = std::numeric_limits<float>::epsilon();
+        const double tol = 2 * eps * abs_sum;
+
+        if (selected(ops, "sum")) {
+            double r = 0;
+            double t = best_time([&] { r = rops::reduce<rops::Sum<float> >(a, n); });
+            report(bytes, "sum", t, bytes, !check || std::fabs(r - ref_sum) <= tol);
+        }
+        if (selected(ops, "sumsq")) {
+            double r = 0;
+            double t = best_time([&] { r = rops::reduce<rops::SumSq<float> >(a, n); });
+            report(bytes, "sumsq", t, bytes, !check || std::fabs(r - ref_sq) <= 2 * eps * ref_sq);
+        }
+        if (selected(ops, "min")) {
+            float r = 0;
+            double t = best_time([&] { r = rops::reduce<rops::Min<float> >(a, n); });
+            report(bytes, "min", t, bytes, !check || r == ref_min);
+        }
+        if (selected(ops, "max")) {
+            float r = 0;
+            double t = best_time([&] { r = rops::reduce<rops::Max<float> >(a, n); });
+            report(bytes, "max", t, bytes, !check || r == ref_max);
+        }
+        if (selected(ops, "argmax")) {
+            rops::ValIdx<float> r = {0, 0};
+            double t = best_time([&] { r = rops::reduce<rops::ArgMax<float> >(a, n); });
+            report(bytes, "argmax", t, bytes, !check || (r.val == ref_max && r.idx == ref_arg));
+        }
+        if (selected(ops, "segsum")) {
+            offsets.resize(1);
+            size_t pos = 0, k = 0;
+            while (pos < n) {
+                pos = std::min(n, pos + 1 + (k++ * 2654435761u) % (2 * kSegLen - 1));
+                offsets.push_back((long long)pos);
+            }
+            const size_t nseg = offsets.size() - 1;
+            seg_out.resize(nseg);
+            double t = best_time([&] {
+                rops::segmented_reduce<rops::Sum<float> >(a, offsets.data(), nseg, seg_out.data());
+            });
+            bool ok = true;
+            if (check) {
+                double total = 0.0;
+                for (size_t s = 0; s < nseg; s++) {
+                    total += seg_out[s];
+                }
+                ok = std::fabs(total - ref_sum) <= tol;
+            }
+            report(bytes, "segsum", t, bytes + (nseg + 1) * sizeof(long long) + nseg * sizeof(double), ok);
+        }
+        // 扫描输出到单独的缓冲区，最大的尺寸放不下第二个数组时跳过
+        if (selected(ops, "scan") && 2 * bytes <= max_bytes) {
+            scan_buf.resize(n);
+            float total = 0;
+            double t = best_time([&] {
+                total = rops::inclusive_scan<rops::Sum<float, float> >(a, scan_buf.data(), n);
+            });
+            // float 顺序累加的误差上界约为 eps * sum(|前缀和|)
+            const double scan_tol = 4 * eps * prefix_abs;
+            bool ok = !check || (std::fabs(total - ref_sum) <= scan_tol && scan_buf[n - 1] == total);
+            // 有效带宽按读一遍输入、写一遍输出计算
+            report(bytes, "scan", t, 2.0 * bytes, ok);
+        }
+    }
+    free(a);
+    return 0;
+}
@@ -0,0 +1,16 @@
+
+// 求和模式
+enum class ReduceMode {
+    Fast,          // 任意重结合，速度最快，结果随线程数变化
+    Kahan,         // Neumaier 补偿求和
+    Pairwise,      // 固定分块的两两求和，树形只由长度决定
+    Reproducible   // 分箱（binned）精确累加，任意线程数下结果按位一致
+};
+
+// CPU 版本的归约，与 gpuReduce 的约定一致：输入为主机内存上的 float 数组，返回求和结果
+float cpuReduce(const float* h_data, const int size);
+float cpuReduce(const float* h_data, const int size, ReduceMode mode);
+
+const char* reduceModeName(ReduceMode mode);
+// 解析 fast / kahan / pairwise / repro，失败返回 false
+bool parseReduceMode(const char* name, ReduceMode* mode);
@@ -0,0 +1,376 @@
+#pragma once
+// 通用的归约 / 分段归约 / 前缀扫描原语，算子作为模板参数，只有头文件。
+//
+// 算子约定（见下面的 Sum / SumSq / Min / Max / ArgMax）：
+//   value_type            输入元素类型
+//   acc_type              累加类型
+//   identity()            单位元
+//   lift(x, i)            把第 i 个元素映射为累加类型
+//   combine(a, b)         结合律成立的二元操作
+//
+// 线程内用多路独立累加器（lanes）打破依赖链，编译器会把它们向量化；
+// 线程间按静态分块切分，部分结果按线程编号顺序合并，线程数固定时结果确定。
+// 输入不能含 NaN。
+
+#include <cstddef>
+#include <limits>
+#include <omp.h>
+
+namespace rops {
+
+// 默认的累加类型：float 用 double 累加，整数用 64 位累加
+template <typename T> struct wider { typedef T type; };
+template <> struct wider<float> { typedef double type; };
+template <> struct wider<int> { typedef long long type; };
+template <> struct wider<unsigned> { typedef unsigned long long type; };
+
+template <typename T, typename A = typename wider<T>::type>
+struct Sum {
+    typedef T value_type;
+    typedef A acc_type;
+    static acc_type identity() { return A(0); }
+    static acc_type lift(T x, size_t) { return A(x); }
+    static acc_type combine(acc_type a, acc_type b) { return a + b; }
+};
+
+// 平方和，用于求向量范数
+template <typename T, typename A = typename wider<T>::type>
+struct SumSq {
+    typedef T value_type;
+    typedef A acc_type;
+    static acc_type identity() { return A(0); }
+    static acc_type lift(T x, size_t) { return A(x) * A(x); }
+    static acc_type combine(acc_type a, acc_type b) { return a + b; }
+};
+
+template <typename T>
+struct Min {
+    typedef T value_type;
+    typedef T acc_type;
+    static acc_type identity() {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::max();
+    }
+    static acc_type lift(T x, size_t) { return x; }
+    static acc_type combine(acc_type a, acc_type b) { return b < a ? b : a; }
+};
+
+template <typename T>
+struct Max {
+    typedef T value_type;
+    typedef T acc_type;
+    static acc_type identity() {
+        return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity()
+                                                    : std::numeric_limits<T>::lowest();
+    }
+    static acc_type lift(T x, size_t) { return x; }
+    static acc_type combine(acc_type a, acc_type b) { return b > a ? b : a; }
+};
+
+template <typename T>
+struct ValIdx {
+    T val;
+    size_t idx;
+};
+
+// 最大值及其下标，值相等时取较小的下标，因此与合并顺序无关
+template <typename T>
+struct ArgMax {
+    typedef T value_type;
+    typedef ValIdx<T> acc_type;
+    static acc_type identity() {
+        acc_type r = {Max<T>::identity(), std::numeric_limits<size_t>::max()};
+        return r;
+    }
+    static acc_type lift(T x, size_t i) {
+        acc_type r = {x, i};
+        return r;
+    }
+    static acc_type combine(acc_type a, acc_type b) {
+        if (b.val > a.val || (b.val == a.val && b.idx < a.idx)) {
+            return b;
+        }
+        return a;
+    }
+};
+
+namespace detail {
+
+// 每个线程至少处理这么多元素才值得开线程
+const size_t kMinPerThread = size_t(1) << 16;
+// 每个线程的起点按 64 字节对齐
+const size_t kAlign = 64;
+const int kMaxThreads = 256;
+
+// 独立累加器个数：四条 512 位向量的宽度，至少 8 路
+template <typename A>
+struct lanes {
+    static const int value = (256 / sizeof(A) > 8) ? int(256 / sizeof(A)) : 8;
+};
+
+template <typename Op>
+struct alignas(64) Padded {
+    typename Op::acc_type v;
+};
+
+// 串行归约 x[begin, end)，下标 i 为全局下标
+template <typename Op>
+struct RangeReducer {
+    typedef typename Op::value_type T;
+    typedef typename Op::acc_type A;
+    static A run(const T* x, size_t begin, size_t end) {
+        const int W = lanes<A>::value;
+        // 很短的区间（如分段归约中的短段）直接串行，省掉多路累加器的初始化与合并
+        if (end - begin < size_t(W)) {
+            A r = Op::identity();
+            for (size_t i = begin; i < end; i++) {
+                r = Op::combine(r, Op::lift(x[i], i));
+            }
+            return r;
+        }
+        A acc[W];
+        for (int j = 0; j < W; j++) {
+            acc[j] = Op::identity();
+        }
+        size_t i = begin;
+        for (; i + W <= end; i += W) {
+            for (int j = 0; j < W; j++) {
+                acc[j] = Op::combine(acc[j], Op::lift(x[i + j], i + j));
+            }
+        }
+        // 尾部同样分散到各路累加器上，避免一条长依赖链
+        for (int j = 0; i + j < end; j++) {
+            acc[j] = Op::combine(acc[j], Op::lift(x[i + j], i + j));
+        }
+        for (int w = W / 2; w > 0; w /= 2) {
+            for (int j = 0; j < w; j++) {
+                acc[j] = Op::combine(acc[j], acc[j + w]);
+            }
+        }
+        return acc[0];
+    }
+};
+
+// float 输入、double 累加时，逐元素转换成 double 会让带宽下降约 40%：
+// 改为在 4096 个元素的小块内用 float 向量累加，每块结束时再加到 double 上
+template <typename Op, typename Inner>
+struct BlockedReducer {
+    typedef typename Op::value_type T;
+    typedef typename Op::acc_type A;
+    static const size_t kBlock = 4096;
+    static A run(const T* x, size_t begin, size_t end) {
+        A acc = Op::identity();
+        for (size_t b = begin; b < end; b += kBlock) {
+            const size_t e = (end - b > kBlock) ? b + kBlock : end;
+            acc = Op::combine(acc, A(RangeReducer<Inner>::run(x, b, e)));
+        }
+        return acc;
+    }
+};
+
+template <>
+struct RangeReducer<Sum<float, double> > : BlockedReducer<Sum<float, double>, Sum<float, float> > {};
+template <>
+struct RangeReducer<SumSq<float, double> > : BlockedReducer<SumSq<float, double>, SumSq<float, float> > {};
+
+// ArgMax 的值和下标混在一个结构里不利于向量化：
+// 先对一个小块求向量化的 Max，只有块内最大值超过当前结果时才回头在块内（已在缓存中）找下标
+template <typename T>
+struct RangeReducer<ArgMax<T> > {
+    typedef typename ArgMax<T>::acc_type A;
+    static const size_t kBlock = 2048;
+    static A run(const T* x, size_t begin, size_t end) {
+        A best = ArgMax<T>::identity();
+        for (size_t b = begin; b < end; b += kBlock) {
+            const size_t e = (end - b > kBlock) ? b + kBlock : end;
+            const T m = RangeReducer<Max<T> >::run(x, b, e);
+            if (m > best.val || best.idx == std::numeric_limits<size_t>::max()) {
+                for (size_t i = b; i < e; i++) {
+                    if (x[i] == m) {
+                        best.val = m;
+                        best.idx = i;
+                        break;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+};
+
+inline int pick_threads(size_t n) {
+    size_t threads = omp_get_max_threads();
+    if (threads > n / kMinPerThread) {
+        threads = n / kMinPerThread;
+    }
+    if (threads > (size_t)kMaxThreads) {
+        threads = kMaxThreads;
+    }
+    return threads < 1 ? 1 : (int)threads;
+}
+
+// 第 tid 个（共 nt 个）线程负责的区间，起点对齐到 kAlign 字节
+template <typename T>
+inline void chunk_of(size_t n, int tid, int nt, size_t* begin, size_t* end) {
+    const size_t step = kAlign / sizeof(T) > 0 ? kAlign / sizeof(T) : 1;
+    const size_t units = (n + step - 1) / step;
+    size_t b = units * tid / nt * step;
+    size_t e = units * (tid + 1) / nt * step;
+    *begin = b < n ? b : n;
+    *end = e < n ? e : n;
+}
+
+// 块内串行扫描，返回扫描完最后一个元素后的累加值
+template <typename Op>
+typename Op::acc_type serial_scan(const typename Op::value_type* in, typename Op::acc_type* out,
+                                  size_t begin, size_t end, typename Op::acc_type acc,
+                                  bool exclusive) {
+    typedef typename Op::acc_type A;
+    if (exclusive) {
+        for (size_t i = begin; i < end; i++) {
+            const A cur = acc;
+            acc = Op::combine(acc, Op::lift(in[i], i));
+            out[i] = cur;
+        }
+    } else {
+        for (size_t i = begin; i < end; i++) {
+            acc = Op::combine(acc, Op::lift(in[i], i));
+            out[i] = acc;
+        }
+    }
+    return acc;
+}
+
+template <typename Op>
+struct ScanKernel {
+    static typename Op::acc_type run(const typename Op::value_type* in, typename Op::acc_type* out,
+                                     size_t begin, size_t end, typename Op::acc_type acc,
+                                     bool exclusive) {
+        return serial_scan<Op>(in, out, begin, end, acc, exclusive);
+    }
+};
+
+// 求和的扫描用 OpenMP 5.0 的 inscan 归约，编译器会生成寄存器内的对数步前缀和。
+// 排他式扫描的输出语句在读输入之前，原地调用时退回串行版本
+template <typename T, typename A>
+struct ScanKernel<Sum<T, A> > {
+    static A run(const T* in, A* out, size_t begin, size_t end, A acc, bool exclusive) {
+        if (exclusive && (const void*)in == (const void*)out) {
+            return serial_scan<Sum<T, A> >(in, out, begin, end, acc, exclusive);
+        }
+        if (exclusive) {
+            #pragma omp simd reduction(inscan, + : acc)
+            for (size_t i = begin; i < end; i++) {
+                out[i] = acc;
+                #pragma omp scan exclusive(acc)
+                acc += A(in[i]);
+            }
+        } else {
+            #pragma omp simd reduction(inscan, + : acc)
+            for (size_t i = begin; i < end; i++) {
+                acc += A(in[i]);
+                #pragma omp scan inclusive(acc)
+                out[i] = acc;
+            }
+        }
+        return acc;
+    }
+};
+
+template <typename Op>
+typename Op::acc_type scan_impl(const typename Op::value_type* in, typename Op::acc_type* out,
+                                size_t n, typename Op::acc_type init, bool exclusive) {
+    typedef typename Op::value_type T;
+    typedef typename Op::acc_type A;
+    const int threads = pick_threads(n);
+    Padded<Op> offset[kMaxThreads + 1];
+    A total = init;
+    #pragma omp parallel num_threads(threads)
+    {
+        const int tid = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        size_t begin, end;
+        chunk_of<T>(n, tid, nt, &begin, &end);
+        // 第一遍：每个线程求自己那一块的总和，最后一块的总和用不到
+        if (tid < nt - 1) {
+            offset[tid + 1].v = RangeReducer<Op>::run(in, begin, end);
+        }
+        #pragma omp barrier
+        #pragma omp single
+        {
+            offset[0].v = init;
+            for (int t = 1; t < nt; t++) {
+                offset[t].v = Op::combine(offset[t - 1].v, offset[t].v);
+            }
+        }
+        // 第二遍：以前面各块的总和为起点做块内扫描，允许 in 与 out 为同一数组
+        const A last = ScanKernel<Op>::run(in, out, begin, end, offset[tid].v, exclusive);
+        if (tid == nt - 1) {
+            total = last;
+        }
+    }
+    return total;
+}
+
+}  // namespace detail
+
+// 归约整个数组
+template <typename Op>
+typename Op::acc_type reduce(const typename Op::value_type* x, size_t n) {
+    typedef typename Op::value_type T;
+    typedef typename Op::acc_type A;
+    const int threads = detail::pick_threads(n);
+    if (threads == 1) {
+        return detail::RangeReducer<Op>::run(x, 0, n);
+    }
+    detail::Padded<Op> partial[detail::kMaxThreads];
+    int used = 1;
+    #pragma omp parallel num_threads(threads)
+    {
+        const int tid = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        size_t begin, end;
+        detail::chunk_of<T>(n, tid, nt, &begin, &end);
+        partial[tid].v = detail::RangeReducer<Op>::run(x, begin, end);
+        if (tid == 0) {
+            used = nt;
+        }
+    }
+    A r = partial[0].v;
+    for (int t = 1; t < used; t++) {
+        r = Op::combine(r, partial[t].v);
+    }
+    return r;
+}
+
+// 分段归约：out[s] = reduce(x[offsets[s], offsets[s + 1]))，offsets 长度为 nseg + 1（CSR 的 row_ptr）。
+// ArgMax 返回的是全局下标。段长差别很大时用 guided 调度平衡负载
+template <typename Op, typename I>
+void segmented_reduce(const typename Op::value_type* x, const I* offsets, size_t nseg,
+                      typename Op::acc_type* out) {
+    const size_t total = nseg > 0 ? (size_t)(offsets[nseg] - offsets[0]) : 0;
+    const int threads = detail::pick_threads(total > nseg ? total : nseg);
+    #pragma omp parallel for schedule(guided) num_threads(threads)
+    for (long long s = 0; s < (long long)nseg; s++) {
+        out[s] = detail::RangeReducer<Op>::run(x, (size_t)offsets[s], (size_t)offsets[s + 1]);
+    }
+}
+
+// 包含式前缀扫描：out[i] = x[0] op ... op x[i]，返回总和。
+// 两遍算法，块内串行、块间按块总和偏移；浮点求和时与纯串行扫描的舍入不一定相同
+template <typename Op>
+typename Op::acc_type inclusive_scan(const typename Op::value_type* in, typename Op::acc_type* out,
+                                     size_t n) {
+    return detail::scan_impl<Op>(in, out, n, Op::identity(), false);
+}
+
+// 排他式前缀扫描：out[0] = init，out[i] = init op x[0] op ... op x[i - 1]，返回 init 与全部元素的总和。
+// 例如由每行非零元个数构造 CSR 的 row_ptr：
+//   row_ptr[m] = rops::exclusive_scan<rops::Sum<int, int> >(counts, row_ptr, m, 0);
+template <typename Op>
+typename Op::acc_type exclusive_scan(const typename Op::value_type* in, typename Op::acc_type* out,
+                                     size_t n, typename Op::acc_type init) {
+    return detail::scan_impl<Op>(in, out, n, init, true);
+}
+
+}  // namespace rops
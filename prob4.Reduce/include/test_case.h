@@ -1 +1,6 @@
-void test_reduce(const int len,const int iter_time);
\ No newline at end of file
+void test_reduce(const int len,const int iter_time);
+
+#ifdef REDUCE_CPU
+// CPU 版本：mode 取 fast / kahan / pairwise / repro / all
+void test_reduce_cpu(const int len,const int iter_time,const char* mode);
+#endif
@@ -4,6 +4,9 @@
 #include <string>
 
 #include "reduce.h"
+#ifdef REDUCE_CPU
+#include "reduce_cpu.h"
+#endif
 #include <iostream>
 #include <vector>
 #include <string>
@@ -16,6 +19,9 @@ void printUsage(const char* programName) {
     std::cout << "Options:\n";
     std::cout << "  -l <size>     Array length (default: 33554432)\n";
     std::cout << "  -t <count>    Number of test runs (default: 10)\n";
+#ifdef REDUCE_CPU
+    std::cout << "  -m <mode>     Reduction mode: fast|kahan|pairwise|repro|all (default: fast)\n";
+#endif
     std::cout << "  -h            Show this help message\n";
     std::cout << "\nExamples:\n";
     std::cout << "  " << programName << " -l 1024000 -t 10\n";
@@ -26,6 +32,9 @@ int main(int argc, char* argv[]) {
     // 默认参数
     int arrayLength = 1024 * 1024 * 32;
     int testTimes = 10;
+#ifdef REDUCE_CPU
+    const char* mode = "fast";
+#endif
     // 解析命令行参数
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-l") == 0) {
@@ -54,6 +63,22 @@ int main(int argc, char* argv[]) {
                 return 1;
             }
         }
+#ifdef REDUCE_CPU
+        else if (strcmp(argv[i], "-m") == 0) {
+            if (i + 1 < argc) {
+                mode = argv[++i];
+                ReduceMode parsed;
+                if (strcmp(mode, "all") != 0 && !parseReduceMode(mode, &parsed)) {
+                    std::cerr << "Error: Unknown mode " << mode << "\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: -m requires an argument!\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+#endif
         else if (strcmp(argv[i], "-h") == 0) {
             printUsage(argv[0]);
             return 0;
@@ -65,7 +90,11 @@ int main(int argc, char* argv[]) {
         }
     }
     // 运行测试
+#ifdef REDUCE_CPU
+    test_reduce_cpu(arrayLength, testTimes, mode);
+#else
     test_reduce(arrayLength, testTimes);
+#endif
     
     return 0;
 }
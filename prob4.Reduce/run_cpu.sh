@@ -0,0 +1,4 @@
+./build/reduce_cpu -l 1024000 -t 10
+./build/reduce_cpu -l 102400000 -t 10
+./build/reduce_cpu -l 8192000 -t 10
+./build/reduce_cpu -l 40960000 -t 10
@@ -0,0 +1,515 @@
+#include "reduce_cpu.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <omp.h>
+#include <immintrin.h>
+
+// 注意：本文件必须在关闭 -ffast-math 的情况下编译（见 CMakeLists.txt），
+// 否则补偿求和与分箱求和中的 (a + b) - a 会被编译器化简掉。
+
+namespace {
+
+// 每个线程至少分到的元素数，小数组开线程得不偿失
+const int kMinPerThread = 1 << 16;
+// 数组超过这个字节数时认为不会留在 LLC 里，改用非临时加载。
+// 实测额外的 prefetchnta 会干扰硬件预取器，带宽反而下降约 20%，因此不再使用
+const size_t kStreamingBytes = size_t(32) << 20;
+// 寄存器累加器每累加这么多元素就刷新到 double 中，控制 float 累加误差
+const int kFlushBlock = 1 << 12;
+// 两两求和的叶子块长度，树的形状只由数组长度决定
+const int kPairBlock = 1 << 10;
+// 分箱求和的层数，每层大约能精确保留 53 - log2(n) 位
+const int kFolds = 3;
+const int kMaxThreads = 256;
+
+// 每个线程的部分结果独占 cache line，避免伪共享
+struct alignas(64) Partial {
+    double value[kFolds];
+};
+
+// ---------------------------------------------------------------------------
+// 向量操作的薄封装：vf 为 float 向量，vd 为 double 向量
+// ---------------------------------------------------------------------------
+#if defined(__AVX512F__)
+// GCC 12 的 AVX-512 头文件用 _mm512_undefined_* 作掩码源，会误报 -Wmaybe-uninitialized
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+typedef __m512 vf;
+typedef __m512d vd;
+const int kLanes = 16;
+const int kDLanes = 8;
+const int kVecAlign = 64;
+
+inline vf vf_zero() { return _mm512_setzero_ps(); }
+inline vf vf_load(const float* p, bool streaming) {
+    if (streaming) {
+        return _mm512_castsi512_ps(_mm512_stream_load_si512((void*)p));
+    }
+    return _mm512_load_ps(p);
+}
+inline vf vf_loadu(const float* p) { return _mm512_loadu_ps(p); }
+inline vf vf_add(vf a, vf b) { return _mm512_add_ps(a, b); }
+inline vf vf_sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+inline vf vf_max_abs(vf m, vf a) { return _mm512_max_ps(m, _mm512_abs_ps(a)); }
+// 按绝对值大小把 a、b 排成 (big, small)
+inline void vf_order(vf a, vf b, vf* big, vf* small) {
+    __mmask16 ge = _mm512_cmp_ps_mask(_mm512_abs_ps(a), _mm512_abs_ps(b), _CMP_GE_OQ);
+    *big = _mm512_mask_blend_ps(ge, b, a);
+    *small = _mm512_mask_blend_ps(ge, a, b);
+}
+// 水平操作很少执行，经由内存完成即可
+inline void vf_store(float* lane, vf v) { _mm512_storeu_ps(lane, v); }
+inline vd vd_zero() { return _mm512_setzero_pd(); }
+inline vd vd_set1(double x) { return _mm512_set1_pd(x); }
+inline vd vd_add(vd a, vd b) { return _mm512_add_pd(a, b); }
+inline vd vd_sub(vd a, vd b) { return _mm512_sub_pd(a, b); }
+inline vd vd_from_float(const float* p) { return _mm512_cvtps_pd(_mm256_loadu_ps(p)); }
+inline void vd_store(double* lane, vd v) { _mm512_storeu_pd(lane, v); }
+#pragma GCC diagnostic pop
+#elif defined(__AVX2__)
+typedef __m256 vf;
+typedef __m256d vd;
+const int kLanes = 8;
+const int kDLanes = 4;
+const int kVecAlign = 32;
+
+inline vf vf_zero() { return _mm256_setzero_ps(); }
+inline vf vf_load(const float* p, bool streaming) {
+    if (streaming) {
+        return _mm256_castsi256_ps(_mm256_stream_load_si256((const __m256i*)p));
+    }
+    return _mm256_load_ps(p);
+}
+inline vf vf_loadu(const float* p) { return _mm256_loadu_ps(p); }
+inline vf vf_add(vf a, vf b) { return _mm256_add_ps(a, b); }
+inline vf vf_sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+inline vf vf_abs(vf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+inline vf vf_max_abs(vf m, vf a) { return _mm256_max_ps(m, vf_abs(a)); }
+inline void vf_order(vf a, vf b, vf* big, vf* small) {
+    vf ge = _mm256_cmp_ps(vf_abs(a), vf_abs(b), _CMP_GE_OQ);
+    *big = _mm256_blendv_ps(b, a, ge);
+    *small = _mm256_blendv_ps(a, b, ge);
+}
+inline void vf_store(float* lane, vf v) { _mm256_storeu_ps(lane, v); }
+inline vd vd_zero() { return _mm256_setzero_pd(); }
+inline vd vd_set1(double x) { return _mm256_set1_pd(x); }
+inline vd vd_add(vd a, vd b) { return _mm256_add_pd(a, b); }
+inline vd vd_sub(vd a, vd b) { return _mm256_sub_pd(a, b); }
+inline vd vd_from_float(const float* p) { return _mm256_cvtps_pd(_mm_loadu_ps(p)); }
+inline void vd_store(double* lane, vd v) { _mm256_storeu_pd(lane, v); }
+#else
+// 没有 AVX 时退化为标量，仍保留多路累加器
+typedef float vf;
+typedef double vd;
+const int kLanes = 1;
+const int kDLanes = 1;
+const int kVecAlign = 4;
+
+inline vf vf_zero() { return 0.0f; }
+inline vf vf_load(const float* p, bool) { return *p; }
+inline vf vf_loadu(const float* p) { return *p; }
+inline vf vf_add(vf a, vf b) { return a + b; }
+inline vf vf_sub(vf a, vf b) { return a - b; }
+inline vf vf_max_abs(vf m, vf a) { return std::fabs(a) > m ? std::fabs(a) : m; }
+inline void vf_order(vf a, vf b, vf* big, vf* small) {
+    bool ge = std::fabs(a) >= std::fabs(b);
+    *big = ge ? a : b;
+    *small = ge ? b : a;
+}
+inline void vf_store(float* lane, vf v) { *lane = v; }
+inline vd vd_zero() { return 0.0; }
+inline vd vd_set1(double x) { return x; }
+inline vd vd_add(vd a, vd b) { return a + b; }
+inline vd vd_sub(vd a, vd b) { return a - b; }
+inline vd vd_from_float(const float* p) { return *p; }
+inline void vd_store(double* lane, vd v) { *lane = v; }
+#endif
+
+inline float vf_hsum(vf v) {
+    float lane[kLanes];
+    vf_store(lane, v);
+    float s = 0.0f;
+    for (int l = 0; l < kLanes; l++) {
+        s += lane[l];
+    }
+    return s;
+}
+
+inline float vf_hmax(vf v) {
+    float lane[kLanes];
+    vf_store(lane, v);
+    float m = 0.0f;
+    for (int l = 0; l < kLanes; l++) {
+        m = lane[l] > m ? lane[l] : m;
+    }
+    return m;
+}
+
+inline double vd_hsum(vd v) {
+    double lane[kDLanes];
+    vd_store(lane, v);
+    double s = 0.0;
+    for (int l = 0; l < kDLanes; l++) {
+        s += lane[l];
+    }
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Fast：四组累加器，每 kFlushBlock 个元素刷新到 double
+// ---------------------------------------------------------------------------
+double sum_fast(const float* p, int n, bool streaming) {
+    double total = 0.0;
+    for (int base = 0; base < n; base += kFlushBlock) {
+        const int len = (n - base < kFlushBlock) ? n - base : kFlushBlock;
+        const float* q = p + base;
+        vf acc0 = vf_zero(), acc1 = vf_zero(), acc2 = vf_zero(), acc3 = vf_zero();
+        int i = 0;
+        for (; i + 4 * kLanes <= len; i += 4 * kLanes) {
+            acc0 = vf_add(acc0, vf_load(q + i, streaming));
+            acc1 = vf_add(acc1, vf_load(q + i + kLanes, streaming));
+            acc2 = vf_add(acc2, vf_load(q + i + 2 * kLanes, streaming));
+            acc3 = vf_add(acc3, vf_load(q + i + 3 * kLanes, streaming));
+        }
+        for (; i + kLanes <= len; i += kLanes) {
+            acc0 = vf_add(acc0, vf_load(q + i, streaming));
+        }
+        acc0 = vf_add(vf_add(acc0, acc1), vf_add(acc2, acc3));
+        float tail = 0.0f;
+        for (; i < len; i++) {
+            tail += q[i];
+        }
+        total += (double)vf_hsum(acc0) + tail;
+    }
+    return total;
+}
+
+// ---------------------------------------------------------------------------
+// Kahan：每个 lane 独立做 Neumaier 补偿，两条链交替以隐藏加法延迟
+// ---------------------------------------------------------------------------
+inline void neumaier_step(vf* s, vf* c, vf x) {
+    vf t = vf_add(*s, x);
+    vf big, small;
+    vf_order(*s, x, &big, &small);
+    *c = vf_add(*c, vf_add(vf_sub(big, t), small));
+    *s = t;
+}
+
+inline void neumaier_step(double* s, double* c, double x) {
+    double t = *s + x;
+    *c += (std::fabs(*s) >= std::fabs(x)) ? (*s - t) + x : (x - t) + *s;
+    *s = t;
+}
+
+double sum_kahan(const float* p, int n, bool streaming) {
+    vf s0 = vf_zero(), c0 = vf_zero(), s1 = vf_zero(), c1 = vf_zero();
+    int i = 0;
+    for (; i + 2 * kLanes <= n; i += 2 * kLanes) {
+        neumaier_step(&s0, &c0, vf_load(p + i, streaming));
+        neumaier_step(&s1, &c1, vf_load(p + i + kLanes, streaming));
+    }
+    for (; i + kLanes <= n; i += kLanes) {
+        neumaier_step(&s0, &c0, vf_load(p + i, streaming));
+    }
+    float sl0[kLanes], cl0[kLanes], sl1[kLanes], cl1[kLanes];
+    vf_store(sl0, s0);
+    vf_store(cl0, c0);
+    vf_store(sl1, s1);
+    vf_store(cl1, c1);
+    // lane 之间在 double 中合并，补偿项单独累加最后再加回
+    double sum = 0.0, comp = 0.0;
+    for (int l = 0; l < kLanes; l++) {
+        neumaier_step(&sum, &comp, (double)sl0[l]);
+        neumaier_step(&sum, &comp, (double)sl1[l]);
+        comp += (double)cl0[l] + (double)cl1[l];
+    }
+    for (; i < n; i++) {
+        neumaier_step(&sum, &comp, (double)p[i]);
+    }
+    return sum + comp;
+}
+
+// ---------------------------------------------------------------------------
+// Pairwise：kPairBlock 大小的叶子块内向量求和，块和之间按固定形状两两相加
+// ---------------------------------------------------------------------------
+float sum_leaf(const float* p, int n) {
+    vf acc0 = vf_zero(), acc1 = vf_zero(), acc2 = vf_zero(), acc3 = vf_zero();
+    int i = 0;
+    for (; i + 4 * kLanes <= n; i += 4 * kLanes) {
+        acc0 = vf_add(acc0, vf_loadu(p + i));
+        acc1 = vf_add(acc1, vf_loadu(p + i + kLanes));
+        acc2 = vf_add(acc2, vf_loadu(p + i + 2 * kLanes));
+        acc3 = vf_add(acc3, vf_loadu(p + i + 3 * kLanes));
+    }
+    for (; i + kLanes <= n; i += kLanes) {
+        acc0 = vf_add(acc0, vf_loadu(p + i));
+    }
+    float s = vf_hsum(vf_add(vf_add(acc0, acc1), vf_add(acc2, acc3)));
+    for (; i < n; i++) {
+        s += p[i];
+    }
+    return s;
+}
+
+float pairwise_tree(const float* v, int n) {
+    if (n == 1) {
+        return v[0];
+    }
+    const int half = n / 2;
+    return pairwise_tree(v, half) + pairwise_tree(v + half, n - half);
+}
+
+// ---------------------------------------------------------------------------
+// Reproducible：分箱求和。σ_k = 2^E_k，q = (σ_k + x) - σ_k 把 x 截到 ulp(σ_k) 的整数倍，
+// 所有 q 的和在 double 中是精确的，因此与相加顺序、线程划分都无关；
+// 余数 x - q 交给下一层。σ 只由 max|x| 与 n 决定。
+// ---------------------------------------------------------------------------
+struct Bins {
+    double sigma[kFolds];
+};
+
+Bins make_bins(float max_abs, int n) {
+    int e = 0;
+    std::frexp((double)max_abs, &e);      // max_abs < 2^e
+    int log_n = 0;
+    while ((1LL << log_n) < (long long)n) {
+        log_n++;
+    }
+    // 第一层保证 n * max|x| < σ/2；之后每层的余数不超过上一层 ulp 的一半
+    Bins bins;
+    int exponent = e + log_n + 1;
+    for (int k = 0; k < kFolds; k++) {
+        bins.sigma[k] = std::ldexp(1.0, exponent);
+        exponent = exponent - 53 + log_n + 1;
+    }
+    return bins;
+}
+
+void sum_binned(const float* p, int n, const Bins& bins, double* out) {
+    vd sigma[kFolds];
+    vd acc[kFolds];
+    for (int k = 0; k < kFolds; k++) {
+        sigma[k] = vd_set1(bins.sigma[k]);
+        acc[k] = vd_zero();
+    }
+    int i = 0;
+    for (; i + kDLanes <= n; i += kDLanes) {
+        vd x = vd_from_float(p + i);
+        for (int k = 0; k < kFolds; k++) {
+            vd q = vd_sub(vd_add(sigma[k], x), sigma[k]);
+            acc[k] = vd_add(acc[k], q);
+            x = vd_sub(x, q);
+        }
+    }
+    for (int k = 0; k < kFolds; k++) {
+        out[k] = vd_hsum(acc[k]);
+    }
+    for (; i < n; i++) {
+        double x = p[i];
+        for (int k = 0; k < kFolds; k++) {
+            double q = (bins.sigma[k] + x) - bins.sigma[k];
+            out[k] += q;
+            x -= q;
+        }
+    }
+}
+
+float max_abs(const float* p, int n) {
+    vf m = vf_zero();
+    int i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        m = vf_max_abs(m, vf_loadu(p + i));
+    }
+    float r = vf_hmax(m);
+    for (; i < n; i++) {
+        r = std::fabs(p[i]) > r ? std::fabs(p[i]) : r;
+    }
+    return r;
+}
+
+// 线程部分和按二叉树两两合并
+double tree_combine(Partial* partial, int count, int fold) {
+    for (int stride = 1; stride < count; stride *= 2) {
+        for (int i = 0; i + stride < count; i += 2 * stride) {
+            partial[i].value[fold] += partial[i + stride].value[fold];
+        }
+    }
+    return count > 0 ? partial[0].value[fold] : 0.0;
+}
+
+int pick_threads(long long n) {
+    long long threads = omp_get_max_threads();
+    if (threads > n / kMinPerThread) {
+        threads = n / kMinPerThread;
+    }
+    if (threads > kMaxThreads) {
+        threads = kMaxThreads;
+    }
+    return threads < 1 ? 1 : (int)threads;
+}
+
+// 按向量宽度对齐切分，使每个线程的起点都是对齐的，返回实际参与的线程数
+template <typename Body>
+int run_partitioned(int n, int threads, Body body) {
+    const int vec_count = n / kLanes;
+    int used = threads;
+    #pragma omp parallel num_threads(threads)
+    {
+        const int tid = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const int begin = (int)((long long)vec_count * tid / nt) * kLanes;
+        const int end = (tid == nt - 1) ? n : (int)((long long)vec_count * (tid + 1) / nt) * kLanes;
+        body(tid, begin, end);
+        if (tid == 0) {
+            used = nt;
+        }
+    }
+    return used;
+}
+
+// 未对齐的头部长度，头部用标量处理
+int aligned_head(const float* p, int size) {
+    int head = (int)(((kVecAlign - ((uintptr_t)p % kVecAlign)) % kVecAlign) / sizeof(float));
+    if ((uintptr_t)p % sizeof(float) != 0 || head > size) {
+        head = size;
+    }
+    return head;
+}
+
+float reduce_fast(const float* h_data, int size) {
+    const int head = aligned_head(h_data, size);
+    double head_sum = 0.0;
+    for (int i = 0; i < head; i++) {
+        head_sum += h_data[i];
+    }
+    const float* body = h_data + head;
+    const int n = size - head;
+    const bool streaming = (size_t)size * sizeof(float) >= kStreamingBytes;
+    Partial partial[kMaxThreads];
+    int used = run_partitioned(n, pick_threads(n), [&](int tid, int begin, int end) {
+        partial[tid].value[0] = sum_fast(body + begin, end - begin, streaming);
+    });
+    return (float)(tree_combine(partial, used, 0) + head_sum);
+}
+
+float reduce_kahan(const float* h_data, int size) {
+    const int head = aligned_head(h_data, size);
+    const float* body = h_data + head;
+    const int n = size - head;
+    const bool streaming = (size_t)size * sizeof(float) >= kStreamingBytes;
+    Partial partial[kMaxThreads];
+    int used = run_partitioned(n, pick_threads(n), [&](int tid, int begin, int end) {
+        partial[tid].value[0] = sum_kahan(body + begin, end - begin, streaming);
+    });
+    // 线程之间同样做补偿合并
+    double sum = 0.0, comp = 0.0;
+    for (int i = 0; i < head; i++) {
+        neumaier_step(&sum, &comp, (double)h_data[i]);
+    }
+    for (int t = 0; t < used; t++) {
+        neumaier_step(&sum, &comp, partial[t].value[0]);
+    }
+    return (float)(sum + comp);
+}
+
+float reduce_pairwise(const float* h_data, int size) {
+    const int blocks = (size + kPairBlock - 1) / kPairBlock;
+    std::vector<float> block_sum(blocks);
+    const int threads = pick_threads(size);
+    #pragma omp parallel for schedule(static) num_threads(threads)
+    for (int b = 0; b < blocks; b++) {
+        const int begin = b * kPairBlock;
+        const int len = (size - begin < kPairBlock) ? size - begin : kPairBlock;
+        block_sum[b] = sum_leaf(h_data + begin, len);
+    }
+    // 块数只有 n / 1024，串行两两合并的开销可以忽略
+    return pairwise_tree(block_sum.data(), blocks);
+}
+
+float reduce_reproducible(const float* h_data, int size) {
+    const int threads = pick_threads(size);
+    float max_value = 0.0f;
+    #pragma omp parallel num_threads(threads) reduction(max:max_value)
+    {
+        const int tid = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+        const int begin = (int)((long long)size * tid / nt);
+        const int end = (int)((long long)size * (tid + 1) / nt);
+        max_value = max_abs(h_data + begin, end - begin);
+    }
+    if (!std::isfinite(max_value)) {
+        // 含 Inf/NaN 时结果本身就是 Inf/NaN，与顺序无关
+        return reduce_fast(h_data, size);
+    }
+    if (max_value == 0.0f) {
+        return 0.0f;
+    }
+    const Bins bins = make_bins(max_value, size);
+    Partial partial[kMaxThreads];
+    int used = run_partitioned(size, threads, [&](int tid, int begin, int end) {
+        sum_binned(h_data + begin, end - begin, bins, partial[tid].value);
+    });
+    // 每一层的和都是精确的，合并顺序不影响结果；最后从低位层往高位层相加
+    double fold[kFolds];
+    for (int k = 0; k < kFolds; k++) {
+        fold[k] = tree_combine(partial, used, k);
+    }
+    double total = fold[kFolds - 1];
+    for (int k = kFolds - 2; k >= 0; k--) {
+        total = fold[k] + total;
+    }
+    return (float)total;
+}
+
+}  // namespace
+
+float cpuReduce(const float* h_data, const int size) {
+    return cpuReduce(h_data, size, ReduceMode::Fast);
+}
+
+float cpuReduce(const float* h_data, const int size, ReduceMode mode) {
+    if (size <= 0) {
+        return 0.0f;
+    }
+    switch (mode) {
+        case ReduceMode::Kahan:
+            return reduce_kahan(h_data, size);
+        case ReduceMode::Pairwise:
+            return reduce_pairwise(h_data, size);
+        case ReduceMode::Reproducible:
+            return reduce_reproducible(h_data, size);
+        case ReduceMode::Fast:
+        default:
+            return reduce_fast(h_data, size);
+    }
+}
+
+const char* reduceModeName(ReduceMode mode) {
+    switch (mode) {
+        case ReduceMode::Kahan:
+            return "kahan";
+        case ReduceMode::Pairwise:
+            return "pairwise";
+        case ReduceMode::Reproducible:
+            return "repro";
+        case ReduceMode::Fast:
+        default:
+            return "fast";
+    }
+}
+
+bool parseReduceMode(const char* name, ReduceMode* mode) {
+    const ReduceMode all[] = {ReduceMode::Fast, ReduceMode::Kahan, ReduceMode::Pairwise,
+                              ReduceMode::Reproducible};
+    for (ReduceMode m : all) {
+        if (strcmp(name, reduceModeName(m)) == 0) {
+            *mode = m;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <iomanip>
+#include <omp.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "utils.h"
+#include "test_case.h"
+#include "reduce_cpu.h"
+
+
+namespace {
+
+// 用指定线程数跑一次，检查结果是否与线程数无关
+float reduce_with_threads(const float* a, int len, ReduceMode mode, int threads){
+    int saved = omp_get_max_threads();
+    omp_set_num_threads(threads);
+    float r = cpuReduce(a, len, mode);
+    omp_set_num_threads(saved);
+    return r;
+}
+
+bool same_bits(float x, float y){
+    return std::memcmp(&x, &y, sizeof(float)) == 0;
+}
+
+void run_mode(const float* a, int len, int iter_time, ReduceMode mode, long double ref){
+    double min_time=1e6;
+    float result=0.0f;
+    for(int i=0;i<iter_time;i++){
+        auto iter_start = std::chrono::high_resolution_clock::now();
+        result=cpuReduce(a, len, mode);
+        auto iter_end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(iter_end - iter_start);
+        min_time = std::min(duration.count() / 1e3,min_time);
+    }
+    // 只读一遍输入，带宽 = 数组字节数 / 时间，可直接与 STREAM 的结果对比
+    double bandwidth = len * sizeof(float) / (min_time * 1e3);
+    long double abs_err = std::fabs((long double)result - ref);
+    long double rel_err = (ref != 0) ? abs_err / std::fabs(ref) : abs_err;
+
+    // 分别用 1 个、全部、以及一个奇数个线程重新求和，比较二进制是否一致
+    const int max_threads = omp_get_max_threads();
+    const int odd_threads = std::max(3, (max_threads - 1) | 1);
+    bool stable = same_bits(result, reduce_with_threads(a, len, mode, 1)) &&
+                  same_bits(result, reduce_with_threads(a, len, mode, odd_threads));
+
+    std::cout<<std::left<<std::setw(9)<<reduceModeName(mode)<<std::right
+             <<" time: "<<std::setw(10)<<min_time<<" us"
+             <<" , bandwidth: "<<std::setw(8)<<bandwidth<<" GB/s"
+             <<" , sum: "<<std::setprecision(9)<<result
+             <<" , abs err: "<<(double)abs_err
+             <<" , rel err: "<<(double)rel_err<<std::setprecision(6)
+             <<" , bitwise stable across threads: "<<(stable ? "yes" : "no")
+             <<std::endl;
+    if(rel_err>1e-5){
+        std::cout<<"Result incorrect! diff is "<<(double)abs_err<<std::endl;
+    }
+}
+
+}  // namespace
+
+
+// 与 test_case.cu 的流程一致，另外给出带宽、相对 long double 参考值的误差以及跨线程数的可复现性
+void test_reduce_cpu(const int len,const int iter_time,const char* mode){
+    float * a =(float*)aligned_alloc(64, ((len * sizeof(float) + 63) / 64) * 64);
+    Gen_Matrix<float>(a,len);
+    long double ref=0.0L;
+    for(int i=0;i<len;i++){
+        ref+=a[i];
+    }
+    std::cout<<"len: "<<len<<" , threads: "<<omp_get_max_threads()
+             <<" , long double reference: "<<std::setprecision(12)<<(double)ref
+             <<std::setprecision(6)<<std::endl;
+
+    const ReduceMode all[] = {ReduceMode::Fast, ReduceMode::Kahan, ReduceMode::Pairwise,
+                              ReduceMode::Reproducible};
+    for(ReduceMode m : all){
+        if(strcmp(mode, "all") == 0 || strcmp(mode, reduceModeName(m)) == 0){
+            run_mode(a, len, iter_time, m, ref);
+        }
+    }
+    free(a);
+
+}
@@ -10,11 +10,7 @@ struct XorShift64 {
         : state(seed ? seed : 88172645463325252ULL) {}
 
     inline uint64_t next() {
-        uint64_t x = state;
-        x ^= x << 13;
-        x ^= x >> 7;
-        x ^= x << 17;
-        return state = x;
+        return state = shift(state);
     }
 
     inline double uniform_double() {
@@ -24,6 +20,47 @@ struct XorShift64 {
     inline int uniform_int(int lo, int hi) {
         return lo + static_cast<int>(uniform_double() * (hi - lo + 1.0));
     }
+
+    // Advance by `steps` calls of next() without making them. next() is
+    // linear over GF(2), so this applies its 64x64 bit matrix raised to
+    // `steps` by repeated squaring: each squaring is 64 apply() calls of up
+    // to 64 shift/xor steps, about 4096 word ops per bit of `steps`.
+    inline void jump(uint64_t steps) {
+        uint64_t m[64], sq[64];  // m[i]: image of bit i under the current power
+        for (int i = 0; i < 64; ++i) {
+            m[i] = shift(1ULL << i);
+        }
+        for (; steps; steps >>= 1) {
+            if (steps & 1) {
+                state = apply(m, state);
+            }
+            for (int i = 0; i < 64; ++i) {
+                sq[i] = apply(m, m[i]);
+            }
+            for (int i = 0; i < 64; ++i) {
+                m[i] = sq[i];
+            }
+        }
+    }
+
+   private:
+    // One step of the generator; jump() builds its matrix from the same body
+    static inline uint64_t shift(uint64_t x) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        return x;
+    }
+
+    static inline uint64_t apply(const uint64_t* m, uint64_t v) {
+        uint64_t r = 0;
+        for (int i = 0; v; ++i, v >>= 1) {
+            if (v & 1) {
+                r ^= m[i];
+            }
+        }
+        return r;
+    }
 };
 
 #endif
\ No newline at end of file
@@ -13,8 +13,28 @@ struct Config {
         double lacunarity = 2.0;
         double base_freq = 0.015625;
         int height_scale = 40;
+        // Droplet erosion order: generation order on one thread (Droplets),
+        // or parallel strips (DropletStrips), faster on many cores but
+        // further from the reference
+        enum class Erosion { Droplets, DropletStrips } erosion = Erosion::Droplets;
     } perlin;
 
+    // Hydraulic erosion applied to the Perlin terrain. droplets = 0 scales
+    // the droplet count with map area: 50000 per 4096 x 4096 pixels
+    struct ErosionConfig {
+        int droplets = 0;
+        int max_lifetime = 30;
+        float inertia = 0.05f;
+        float sediment_capacity = 4.0f;
+        float min_slope = 0.01f;
+        float erode_speed = 0.3f;
+        float deposit_speed = 0.3f;
+        float evaporate_speed = 0.01f;
+        float gravity = 4.0f;
+        float initial_water = 1.0f;
+        float initial_speed = 1.0f;
+    } erosion;
+
     struct BombConfig {
         int count = 3000;
         int r_min = 6;
@@ -31,6 +51,7 @@ struct Config {
     struct SeedConfig {
         uint64_t events = 123456789;
         uint64_t perlin = 987654321;
+        uint64_t erosion = 123456789;
     } seeds;
 };
 
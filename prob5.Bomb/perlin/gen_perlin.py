@@ -45,6 +45,10 @@ def main():
         perlin_seed
     ]
 
+    # The baseline erodes a fixed 50000 droplets at every size; pin it so
+    # submissions are compared on the same work
+    output_values.append('droplets=50000')
+
     print(' '.join(map(str, output_values)))
 
 if __name__ == '__main__':
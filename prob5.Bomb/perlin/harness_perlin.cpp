@@ -6,9 +6,15 @@
  * `generate_terrain` function, measures its execution time, and validates
  * the result by computing a hash of the output.
  *
- * It now supports two optional command-line arguments:
+ * It now supports four optional command-line arguments:
  *   --visualize <output_filename.ppm>  (for color PPM image)
  *   --output-raw <output_filename.raw> (for raw binary height data)
+ *   --threads <n>                      (OpenMP threads, to measure scaling)
+ *   --erosion <droplets|strips>        (erosion mode, see Config::PerlinConfig)
+ *
+ * The eight positional config values may be followed by erosion settings as
+ * `key=value` tokens (keys as in Config::ErosionConfig, plus erosion_seed),
+ * e.g. `droplets=200000 max_lifetime=40`. Unset keys keep their defaults.
  *
  * It is NOT intended to be modified by the contestant.
  */
@@ -21,6 +27,10 @@
 #include <string>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "../framework/hash.h"
 #include "../framework/ppm_writer.h"
 #include "../framework/timer.h"
@@ -68,6 +78,34 @@ void read_config_from_stdin(Config& cfg) {
     if (std::cin.fail()) {
         throw std::runtime_error("Failed to read configuration from stdin.");
     }
+
+    Config::ErosionConfig& e = cfg.erosion;
+    std::string token;
+    while (std::cin >> token) {
+        const size_t eq = token.find('=');
+        const std::string key = token.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : token.substr(eq + 1);
+        try {
+            if (key == "droplets") e.droplets = std::stoi(value);
+            else if (key == "max_lifetime") e.max_lifetime = std::stoi(value);
+            else if (key == "inertia") e.inertia = std::stof(value);
+            else if (key == "sediment_capacity") e.sediment_capacity = std::stof(value);
+            else if (key == "min_slope") e.min_slope = std::stof(value);
+            else if (key == "erode_speed") e.erode_speed = std::stof(value);
+            else if (key == "deposit_speed") e.deposit_speed = std::stof(value);
+            else if (key == "evaporate_speed") e.evaporate_speed = std::stof(value);
+            else if (key == "gravity") e.gravity = std::stof(value);
+            else if (key == "initial_water") e.initial_water = std::stof(value);
+            else if (key == "initial_speed") e.initial_speed = std::stof(value);
+            else if (key == "erosion_seed") cfg.seeds.erosion = std::stoull(value);
+            else throw std::invalid_argument(key);
+        } catch (const std::logic_error&) {
+            throw std::runtime_error("Bad erosion setting in config: " + token);
+        }
+    }
+    if (e.droplets < 0 || e.max_lifetime < 1) {
+        throw std::runtime_error("Erosion settings out of range.");
+    }
 }
 
 int main(int argc, char* argv[]) {
@@ -75,18 +113,38 @@ int main(int argc, char* argv[]) {
     std::cin.tie(nullptr);
     std::string visualize_filename = "";
     std::string raw_output_filename = "";
+    std::string erosion_mode = "droplets";
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--visualize" && i + 1 < argc) {
             visualize_filename = argv[++i];
         } else if (arg == "--output-raw" && i + 1 < argc) {
             raw_output_filename = argv[++i];
+        } else if (arg == "--erosion" && i + 1 < argc) {
+            erosion_mode = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            const int threads = std::max(1, std::stoi(argv[++i]));
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#else
+            if (threads > 1) {
+                std::cerr << "Warning: built without OpenMP, --threads ignored"
+                          << std::endl;
+            }
+#endif
         }
     }
 
     try {
         Config cfg;
         read_config_from_stdin(cfg);
+        if (erosion_mode == "droplets") {
+            cfg.perlin.erosion = Config::PerlinConfig::Erosion::Droplets;
+        } else if (erosion_mode == "strips") {
+            cfg.perlin.erosion = Config::PerlinConfig::Erosion::DropletStrips;
+        } else {
+            throw std::runtime_error("Unknown erosion mode: " + erosion_mode);
+        }
 
         std::vector<uint8_t> height_map(static_cast<size_t>(cfg.H) * cfg.W);
 
@@ -1,11 +1,21 @@
 /**
- * @file baseline_perlin.cpp
- * @brief Reference implementation used for benchmarking and validation.
+ * @file submit_perlin.cpp
+ * @brief Optimised terrain generator: SIMD Perlin noise plus droplet erosion.
  *
- * Kept immutable to provide a stable baseline. Contestants should optimize
- * `submit_perlin.cpp` and compare against this file using the provided tools.
+ * Noise is evaluated for 16 (AVX-512) or 8 (AVX2) x-adjacent samples per
+ * call. Lattice coordinates are split in double precision, so the cell index
+ * and the in-cell offset are exact, and the rest of the evaluation runs in
+ * float lanes. The four corner gradients of every lattice cell are packed
+ * into one byte of a 64 KB table, so each evaluation does a single gather and
+ * selects gradients by flipping sign bits. The domain warp is walked along
+ * each scanline cell by cell (WarpScanline). The ISA is picked at run time, so
+ * the file builds with the plain Makefile flags; CPUs without AVX2 fall back
+ * to the scalar reference path. Rows are spread over OpenMP threads in fixed
+ * tiles. Erosion advances droplets 16 at a time (see Erosion::ErosionSimulator).
  */
 
+#include <immintrin.h>
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
@@ -28,6 +38,18 @@ class PerlinNoiseGenerator {
         for (int i = 0; i < 256; ++i) {
             p[i + 256] = p[i];
         }
+        // Gradient codes of the four corners of every cell: aa, ba, ab, bb
+        // in bits 0-1, 2-3, 4-5, 6-7, indexed by (X << 8) | Y. The table is
+        // padded because 32-bit gathers read 4 bytes from a byte index.
+        codes.assign(256 * 256 + 4, 0);
+        for (int X = 0; X < 256; ++X) {
+            for (int Y = 0; Y < 256; ++Y) {
+                const int aa = p[p[X] + Y], ab = p[p[X] + Y + 1],
+                          ba = p[p[X + 1] + Y], bb = p[p[X + 1] + Y + 1];
+                codes[(X << 8) | Y] = static_cast<uint8_t>(
+                    (aa & 3) | (ba & 3) << 2 | (ab & 3) << 4 | (bb & 3) << 6);
+            }
+        }
     }
     double noise(double x, double y) const {
         const int X = static_cast<int>(std::floor(x)) & 255;
@@ -44,8 +66,13 @@ class PerlinNoiseGenerator {
         return (res + 1.0) / 2.0;
     }
 
+    /** @brief Corner gradient codes per lattice cell, for the SIMD kernels. */
+    const uint8_t* cell_codes() const { return codes.data(); }
+    int cell_code(int X, int Y) const { return codes[((X & 255) << 8) | (Y & 255)]; }
+
    private:
     std::vector<int> p;
+    std::vector<uint8_t> codes;
     static inline double fade(double t) {
         return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
     }
@@ -69,168 +96,794 @@ class PerlinNoiseGenerator {
 };
 }  // namespace PerlinBaseline
 
+namespace PerlinSimd {
+
+const double SHAPING_EXPONENT = 1.5;
+const double WARP_FREQUENCY = 0.005;
+const double WARP_AMPLITUDE = 60.0;
+const double WARP_OFFSET_X = 123.4;
+const double WARP_OFFSET_Y = 567.8;
+
+/** Rows handed to a thread at a time; a tile is a few MB of output at 16k. */
+const int ROWS_PER_TILE = 16;
+
+/** @brief Octave weights, precomputed as in the reference loop. */
+struct Octaves {
+    int count;
+    double frequency[32];
+    float amplitude[32];
+    float inv_max_amplitude;  // 0 if there are no octaves
+
+    explicit Octaves(const Config::PerlinConfig& cfg) {
+        count = std::min(std::max(cfg.octaves, 0), 32);
+        double amp = 1.0, freq = cfg.base_freq, max_amp = 0.0;
+        for (int o = 0; o < count; ++o) {
+            frequency[o] = freq;
+            amplitude[o] = static_cast<float>(amp);
+            max_amp += amp;
+            amp *= cfg.persistence;
+            freq *= cfg.lacunarity;
+        }
+        inv_max_amplitude = max_amp > 0.0 ? static_cast<float>(1.0 / max_amp) : 0.0f;
+    }
+};
+
+/**
+ * @brief One scanline of a domain-warp field, walked cell by cell.
+ *
+ * With y fixed, a lattice cell's corner hashes, yf and fade(yf) are shared by
+ * every pixel inside it, and the noise reduces to
+ *   2 * noise - 1 = c0 + c1 * xf + fade(xf) * (c2 + c3 * xf).
+ * start() computes the four coefficients of each cell the row crosses, so a
+ * pixel costs one fade() instead of a full noise evaluation. The warp lattice
+ * is 200 pixels wide, so a SIMD block touches at most two cells.
+ */
+class WarpScanline {
+   public:
+    /** Pixel (x, y) samples the noise at ((x + x_offset) * F, (y + y_offset) * F). */
+    WarpScanline(const PerlinBaseline::PerlinNoiseGenerator& gen, double x_offset,
+                 double y_offset, int W)
+        : gen_(gen), x_offset_(x_offset), y_offset_(y_offset) {
+        first_ = cell_of(0);
+        // Up to the second cell of a block starting at the last pixel
+        cells_ = cell_of(W - 1 + 16) - first_ + 2;
+        coef_.resize(static_cast<size_t>(cells_) * 4);
+    }
+
+    double x_offset() const { return x_offset_; }
+
+    /** @brief Lattice cell of pixel column x. */
+    int cell_of(int x) const {
+        return static_cast<int>(std::floor((x + x_offset_) * WARP_FREQUENCY));
+    }
+
+    /** @brief Coefficients c0..c3 of lattice cell X on the current row. */
+    const float* coef(int X) const { return &coef_[static_cast<size_t>(X - first_) * 4]; }
+
+    void start(int y) {
+        const double cy = (y + y_offset_) * WARP_FREQUENCY;
+        const int Y = static_cast<int>(std::floor(cy));
+        const double yf = cy - std::floor(cy);
+        const double v = yf * yf * yf * (yf * (yf * 6.0 - 15.0) + 10.0);
+        for (int k = 0; k < cells_; ++k) {
+            const int code = gen_.cell_code(first_ + k, Y);
+            // Corner n's gradient is sx * x + sy * y with x = xf - (n & 1),
+            // y = yf - (n >> 1); sx, sy from bits 2n, 2n + 1 of the code
+            double m[4], c[4];
+            for (int n = 0; n < 4; ++n) {
+                const double sx = (code >> (2 * n)) & 1 ? -1.0 : 1.0;
+                const double sy = (code >> (2 * n + 1)) & 1 ? -1.0 : 1.0;
+                m[n] = sx;
+                c[n] = -sx * (n & 1) + sy * (yf - (n >> 1));
+            }
+            // lerp(lerp(aa, ba, u), lerp(ab, bb, u), v) with aa, ba, ab, bb
+            // = corners 0, 1, 2, 3
+            float* out = &coef_[static_cast<size_t>(k) * 4];
+            out[0] = static_cast<float>((1 - v) * c[0] + v * c[2]);
+            out[1] = static_cast<float>((1 - v) * m[0] + v * m[2]);
+            out[2] = static_cast<float>((1 - v) * (c[1] - c[0]) + v * (c[3] - c[2]));
+            out[3] = static_cast<float>((1 - v) * (m[1] - m[0]) + v * (m[3] - m[2]));
+        }
+    }
+
+   private:
+    const PerlinBaseline::PerlinNoiseGenerator& gen_;
+    double x_offset_, y_offset_;
+    int first_, cells_;
+    std::vector<float> coef_;
+};
+
+// ---------------------------------------------------------------- AVX-512 ---
+
+// GCC 12's AVX-512 headers seed unmasked intrinsics with an undefined vector,
+// which -Wall reports as an uninitialized read at every inlined call
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/**
+ * @brief grad() of corner K for 16 lanes: bit 2K of the cell code negates x,
+ * bit 2K + 1 negates y.
+ */
+template <int K>
+__attribute__((target("avx512f"))) static inline __m512 grad16(__m512i code,
+                                                                 __m512 x,
+                                                                 __m512 y) {
+    const __m512i sign = _mm512_set1_epi32(INT32_MIN);
+    const __m512i sx = _mm512_and_si512(_mm512_slli_epi32(code, 31 - 2 * K), sign);
+    const __m512i sy = _mm512_and_si512(_mm512_slli_epi32(code, 30 - 2 * K), sign);
+    return _mm512_add_ps(
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(x), sx)),
+        _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(y), sy)));
+}
+
+__attribute__((target("avx512f"))) static inline __m512 fade16(__m512 t) {
+    const __m512 p = _mm512_fmadd_ps(t, _mm512_set1_ps(6.0f),
+                                     _mm512_set1_ps(-15.0f));
+    const __m512 q = _mm512_fmadd_ps(t, p, _mm512_set1_ps(10.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(t, t), t), q);
+}
+
+__attribute__((target("avx512f"))) static inline __m512 lerp16(__m512 a,
+                                                                 __m512 b,
+                                                                 __m512 t) {
+    return _mm512_fmadd_ps(t, _mm512_sub_ps(b, a), a);
+}
+
+/** @brief Cell index (& 255) and offset of 8 coordinates, as int32 / float. */
+__attribute__((target("avx512f"))) static inline void split8(__m512d c,
+                                                               __m256i* cell,
+                                                               __m256* frac) {
+    const __m512d f = _mm512_roundscale_pd(c, _MM_FROUND_TO_NEG_INF);
+    *cell = _mm256_and_si256(_mm512_cvttpd_epi32(f), _mm256_set1_epi32(255));
+    *frac = _mm512_cvtpd_ps(_mm512_sub_pd(c, f));
+}
+
+/**
+ * @brief Perlin noise at 16 points, lanes 0-7 from (x0, y0), 8-15 from
+ * (x1, y1). Same value as PerlinNoiseGenerator::noise up to float rounding;
+ * the four corner hashes come from a single gather of the cell code.
+ */
+__attribute__((target("avx512f"))) static inline __m512 noise16(
+    const uint8_t* codes, __m512d x0, __m512d x1, __m512d y0, __m512d y1) {
+    __m256i cx0, cx1, cy0, cy1;
+    __m256 fx0, fx1, fy0, fy1;
+    split8(x0, &cx0, &fx0);
+    split8(x1, &cx1, &fx1);
+    split8(y0, &cy0, &fy0);
+    split8(y1, &cy1, &fy1);
+    const __m512i X = _mm512_inserti64x4(_mm512_castsi256_si512(cx0), cx1, 1);
+    const __m512i Y = _mm512_inserti64x4(_mm512_castsi256_si512(cy0), cy1, 1);
+    const __m512 xf = _mm512_castpd_ps(_mm512_insertf64x4(
+        _mm512_castpd256_pd512(_mm256_castps_pd(fx0)), _mm256_castps_pd(fx1), 1));
+    const __m512 yf = _mm512_castpd_ps(_mm512_insertf64x4(
+        _mm512_castpd256_pd512(_mm256_castps_pd(fy0)), _mm256_castps_pd(fy1), 1));
+
+    const __m512i idx = _mm512_or_si512(_mm512_slli_epi32(X, 8), Y);
+    const __m512i code = _mm512_i32gather_epi32(idx, codes, 1);
+
+    const __m512 u = fade16(xf), v = fade16(yf);
+    const __m512 xm = _mm512_sub_ps(xf, _mm512_set1_ps(1.0f));
+    const __m512 ym = _mm512_sub_ps(yf, _mm512_set1_ps(1.0f));
+    const __m512 res =
+        lerp16(lerp16(grad16<0>(code, xf, yf), grad16<1>(code, xm, yf), u),
+               lerp16(grad16<2>(code, xf, ym), grad16<3>(code, xm, ym), u), v);
+    return _mm512_fmadd_ps(res, _mm512_set1_ps(0.5f), _mm512_set1_ps(0.5f));
+}
+
+/** @brief Low / high 8 lanes of a float vector widened to double. */
+__attribute__((target("avx512f"))) static inline __m512d lo8(__m512 v) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(v));
+}
+__attribute__((target("avx512f"))) static inline __m512d hi8(__m512 v) {
+    return _mm512_cvtps_pd(
+        _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(v), 1)));
+}
+
+/**
+ * @brief 2 * noise - 1 of a warp field at pixels [x, x + 16) of its current
+ * row; xa / xb are the pixel columns of lanes 0-7 / 8-15.
+ */
+__attribute__((target("avx512f"))) static inline __m512 warp16(
+    const WarpScanline& row, int x, __m512d xa, __m512d xb) {
+    const __m512d off = _mm512_set1_pd(row.x_offset());
+    const __m512d wf = _mm512_set1_pd(WARP_FREQUENCY);
+    const __m512d ca = _mm512_mul_pd(_mm512_add_pd(xa, off), wf);
+    const __m512d cb = _mm512_mul_pd(_mm512_add_pd(xb, off), wf);
+    const __m512d fa = _mm512_roundscale_pd(ca, _MM_FROUND_TO_NEG_INF);
+    const __m512d fb = _mm512_roundscale_pd(cb, _MM_FROUND_TO_NEG_INF);
+    const __m512 xf = _mm512_castpd_ps(_mm512_insertf64x4(
+        _mm512_castpd256_pd512(_mm256_castps_pd(_mm512_cvtpd_ps(_mm512_sub_pd(ca, fa)))),
+        _mm256_castps_pd(_mm512_cvtpd_ps(_mm512_sub_pd(cb, fb))), 1));
+
+    // Lanes past the block's first cell take the next cell's coefficients
+    const int X = row.cell_of(x);
+    const __m512d first = _mm512_set1_pd(X);
+    const __mmask16 next = static_cast<__mmask16>(
+        _mm512_cmp_pd_mask(fa, first, _CMP_GT_OQ) |
+        _mm512_cmp_pd_mask(fb, first, _CMP_GT_OQ) << 8);
+    const float* lo = row.coef(X);
+    const float* hi = row.coef(X + 1);
+    __m512 c[4];
+    for (int k = 0; k < 4; ++k) {
+        c[k] = _mm512_mask_blend_ps(next, _mm512_set1_ps(lo[k]), _mm512_set1_ps(hi[k]));
+    }
+    return _mm512_fmadd_ps(fade16(xf), _mm512_fmadd_ps(c[3], xf, c[2]),
+                           _mm512_fmadd_ps(c[1], xf, c[0]));
+}
+
+/** @brief Shaped noise height of pixels [0, W) of row y into out. */
+__attribute__((target("avx512f"))) static void terrain_row_avx512(
+    const uint8_t* codes, const WarpScanline& warp_x, const WarpScanline& warp_y,
+    const Octaves& oct, int y, int W, float* out) {
+    const __m512d iota = _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0);
+    const __m512d wa = _mm512_set1_pd(WARP_AMPLITUDE);
+    const __m512d yd = _mm512_set1_pd(y);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    for (int x = 0; x < W; x += 16) {
+        const __m512d xa = _mm512_add_pd(_mm512_set1_pd(x), iota);
+        const __m512d xb = _mm512_add_pd(xa, _mm512_set1_pd(8));
+        const __m512 s1 = warp16(warp_x, x, xa, xb);
+        const __m512 s2 = warp16(warp_y, x, xa, xb);
+        const __m512d wxa = _mm512_fmadd_pd(wa, lo8(s1), xa);
+        const __m512d wxb = _mm512_fmadd_pd(wa, hi8(s1), xb);
+        const __m512d wya = _mm512_fmadd_pd(wa, lo8(s2), yd);
+        const __m512d wyb = _mm512_fmadd_pd(wa, hi8(s2), yd);
+
+        __m512 total = _mm512_setzero_ps();
+        for (int o = 0; o < oct.count; ++o) {
+            const __m512d f = _mm512_set1_pd(oct.frequency[o]);
+            const __m512 n = noise16(codes, _mm512_mul_pd(wxa, f), _mm512_mul_pd(wxb, f),
+                                     _mm512_mul_pd(wya, f), _mm512_mul_pd(wyb, f));
+            total = _mm512_fmadd_ps(n, _mm512_set1_ps(oct.amplitude[o]), total);
+        }
+        total = _mm512_mul_ps(total, _mm512_set1_ps(oct.inv_max_amplitude));
+        total = _mm512_min_ps(_mm512_max_ps(total, _mm512_setzero_ps()), one);
+        // pow(t, 1.5) as t * sqrt(t)
+        total = _mm512_mul_ps(total, _mm512_sqrt_ps(total));
+        const int n = std::min(16, W - x);
+        _mm512_mask_storeu_ps(out + x, static_cast<__mmask16>((1u << n) - 1), total);
+    }
+}
+
+#pragma GCC diagnostic pop
+
+// ------------------------------------------------------------------- AVX2 ---
+
+template <int K>
+__attribute__((target("avx2,fma"))) static inline __m256 grad8(__m256i code,
+                                                                 __m256 x,
+                                                                 __m256 y) {
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i sx = _mm256_and_si256(_mm256_slli_epi32(code, 31 - 2 * K), sign);
+    const __m256i sy = _mm256_and_si256(_mm256_slli_epi32(code, 30 - 2 * K), sign);
+    return _mm256_add_ps(_mm256_xor_ps(x, _mm256_castsi256_ps(sx)),
+                         _mm256_xor_ps(y, _mm256_castsi256_ps(sy)));
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256 fade8(__m256 t) {
+    const __m256 p = _mm256_fmadd_ps(t, _mm256_set1_ps(6.0f), _mm256_set1_ps(-15.0f));
+    const __m256 q = _mm256_fmadd_ps(t, p, _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), q);
+}
+
+__attribute__((target("avx2,fma"))) static inline __m256 lerp8(__m256 a,
+                                                                 __m256 b,
+                                                                 __m256 t) {
+    return _mm256_fmadd_ps(t, _mm256_sub_ps(b, a), a);
+}
+
+__attribute__((target("avx2,fma"))) static inline void split4(__m256d c,
+                                                                __m128i* cell,
+                                                                __m128* frac) {
+    const __m256d f = _mm256_floor_pd(c);
+    *cell = _mm_and_si128(_mm256_cvttpd_epi32(f), _mm_set1_epi32(255));
+    *frac = _mm256_cvtpd_ps(_mm256_sub_pd(c, f));
+}
+
+/** @brief Perlin noise at 8 points, lanes 0-3 from (x0, y0), 4-7 from (x1, y1). */
+__attribute__((target("avx2,fma"))) static inline __m256 noise8(
+    const uint8_t* codes, __m256d x0, __m256d x1, __m256d y0, __m256d y1) {
+    __m128i cx0, cx1, cy0, cy1;
+    __m128 fx0, fx1, fy0, fy1;
+    split4(x0, &cx0, &fx0);
+    split4(x1, &cx1, &fx1);
+    split4(y0, &cy0, &fy0);
+    split4(y1, &cy1, &fy1);
+    const __m256i X = _mm256_inserti128_si256(_mm256_castsi128_si256(cx0), cx1, 1);
+    const __m256i Y = _mm256_inserti128_si256(_mm256_castsi128_si256(cy0), cy1, 1);
+    const __m256 xf = _mm256_insertf128_ps(_mm256_castps128_ps256(fx0), fx1, 1);
+    const __m256 yf = _mm256_insertf128_ps(_mm256_castps128_ps256(fy0), fy1, 1);
+
+    const __m256i idx = _mm256_or_si256(_mm256_slli_epi32(X, 8), Y);
+    const __m256i code =
+        _mm256_i32gather_epi32(reinterpret_cast<const int*>(codes), idx, 1);
+
+    const __m256 u = fade8(xf), v = fade8(yf);
+    const __m256 xm = _mm256_sub_ps(xf, _mm256_set1_ps(1.0f));
+    const __m256 ym = _mm256_sub_ps(yf, _mm256_set1_ps(1.0f));
+    const __m256 res =
+        lerp8(lerp8(grad8<0>(code, xf, yf), grad8<1>(code, xm, yf), u),
+              lerp8(grad8<2>(code, xf, ym), grad8<3>(code, xm, ym), u), v);
+    return _mm256_fmadd_ps(res, _mm256_set1_ps(0.5f), _mm256_set1_ps(0.5f));
+}
+
+/** @brief warp16() for 8 pixels; xa / xb are the columns of lanes 0-3 / 4-7. */
+__attribute__((target("avx2,fma"))) static inline __m256 warp8(
+    const WarpScanline& row, int x, __m256d xa, __m256d xb) {
+    const __m256d off = _mm256_set1_pd(row.x_offset());
+    const __m256d wf = _mm256_set1_pd(WARP_FREQUENCY);
+    const __m256d ca = _mm256_mul_pd(_mm256_add_pd(xa, off), wf);
+    const __m256d cb = _mm256_mul_pd(_mm256_add_pd(xb, off), wf);
+    const __m256d fa = _mm256_floor_pd(ca);
+    const __m256d fb = _mm256_floor_pd(cb);
+    const __m256 xf = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_sub_pd(ca, fa))),
+        _mm256_cvtpd_ps(_mm256_sub_pd(cb, fb)), 1);
+
+    const int X = row.cell_of(x);
+    const __m256d first = _mm256_set1_pd(X);
+    const __m256 next = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm256_cvtpd_ps(_mm256_cmp_pd(fa, first, _CMP_GT_OQ))),
+        _mm256_cvtpd_ps(_mm256_cmp_pd(fb, first, _CMP_GT_OQ)), 1);
+    const float* lo = row.coef(X);
+    const float* hi = row.coef(X + 1);
+    __m256 c[4];
+    for (int k = 0; k < 4; ++k) {
+        c[k] = _mm256_blendv_ps(_mm256_set1_ps(lo[k]), _mm256_set1_ps(hi[k]), next);
+    }
+    return _mm256_fmadd_ps(fade8(xf), _mm256_fmadd_ps(c[3], xf, c[2]),
+                           _mm256_fmadd_ps(c[1], xf, c[0]));
+}
+
+__attribute__((target("avx2,fma"))) static void terrain_row_avx2(
+    const uint8_t* codes, const WarpScanline& warp_x, const WarpScanline& warp_y,
+    const Octaves& oct, int y, int W, float* out) {
+    const __m256d iota = _mm256_set_pd(3, 2, 1, 0);
+    const __m256d wa = _mm256_set1_pd(WARP_AMPLITUDE);
+    const __m256d yd = _mm256_set1_pd(y);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    alignas(32) float tail[8];
+    for (int x = 0; x < W; x += 8) {
+        const __m256d xa = _mm256_add_pd(_mm256_set1_pd(x), iota);
+        const __m256d xb = _mm256_add_pd(xa, _mm256_set1_pd(4));
+        const __m256 s1 = warp8(warp_x, x, xa, xb);
+        const __m256 s2 = warp8(warp_y, x, xa, xb);
+        const __m256d wxa = _mm256_fmadd_pd(wa, _mm256_cvtps_pd(_mm256_castps256_ps128(s1)), xa);
+        const __m256d wxb = _mm256_fmadd_pd(wa, _mm256_cvtps_pd(_mm256_extractf128_ps(s1, 1)), xb);
+        const __m256d wya = _mm256_fmadd_pd(wa, _mm256_cvtps_pd(_mm256_castps256_ps128(s2)), yd);
+        const __m256d wyb = _mm256_fmadd_pd(wa, _mm256_cvtps_pd(_mm256_extractf128_ps(s2, 1)), yd);
+
+        __m256 total = _mm256_setzero_ps();
+        for (int o = 0; o < oct.count; ++o) {
+            const __m256d f = _mm256_set1_pd(oct.frequency[o]);
+            const __m256 n = noise8(codes, _mm256_mul_pd(wxa, f), _mm256_mul_pd(wxb, f),
+                                    _mm256_mul_pd(wya, f), _mm256_mul_pd(wyb, f));
+            total = _mm256_fmadd_ps(n, _mm256_set1_ps(oct.amplitude[o]), total);
+        }
+        total = _mm256_mul_ps(total, _mm256_set1_ps(oct.inv_max_amplitude));
+        total = _mm256_min_ps(_mm256_max_ps(total, _mm256_setzero_ps()), one);
+        total = _mm256_mul_ps(total, _mm256_sqrt_ps(total));
+        if (x + 8 <= W) {
+            _mm256_storeu_ps(out + x, total);
+        } else {
+            _mm256_store_ps(tail, total);
+            std::copy(tail, tail + (W - x), out + x);
+        }
+    }
+}
+
+// ----------------------------------------------------------------- scalar ---
+
+static void terrain_row_scalar(const PerlinBaseline::PerlinNoiseGenerator& gen,
+                               const PerlinBaseline::PerlinNoiseGenerator& warp,
+                               const Config::PerlinConfig& cfg, int y, int W,
+                               float* out) {
+    for (int x = 0; x < W; ++x) {
+        double q1 = warp.noise(x * WARP_FREQUENCY, y * WARP_FREQUENCY);
+        double q2 = warp.noise((x + WARP_OFFSET_X) * WARP_FREQUENCY,
+                               (y + WARP_OFFSET_Y) * WARP_FREQUENCY);
+        double warped_x = static_cast<double>(x) + WARP_AMPLITUDE * (2.0 * q1 - 1.0);
+        double warped_y = static_cast<double>(y) + WARP_AMPLITUDE * (2.0 * q2 - 1.0);
+
+        double total_noise = 0.0, amplitude = 1.0, frequency = cfg.base_freq,
+               max_amplitude = 0.0;
+        for (int o = 0; o < cfg.octaves; ++o) {
+            total_noise +=
+                gen.noise(warped_x * frequency, warped_y * frequency) * amplitude;
+            max_amplitude += amplitude;
+            amplitude *= cfg.persistence;
+            frequency *= cfg.lacunarity;
+        }
+        if (max_amplitude > 0.0) {
+            total_noise /= max_amplitude;
+        }
+        total_noise = std::max(0.0, std::min(1.0, total_noise));
+        total_noise = pow(total_noise, SHAPING_EXPONENT);
+        out[x] = static_cast<float>(total_noise);
+    }
+}
+
+enum class Isa { Scalar, Avx2, Avx512 };
+
+inline Isa detect_isa() {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::Avx2;
+    return Isa::Scalar;
+}
+
+}  // namespace PerlinSimd
+
 namespace Erosion {
 
-struct Droplet {
-    float posX, posY;
-    float dirX, dirY;
-    float velocity;
-    float water;
-    float sediment;
+/** Droplets advanced in lockstep; one AVX-512 vector of floats. */
+const int BATCH = 16;
+
+/** SoA state of one batch of droplets. */
+struct DropletBatch {
+    alignas(64) float posX[BATCH];
+    alignas(64) float posY[BATCH];
+    alignas(64) float dirX[BATCH];
+    alignas(64) float dirY[BATCH];
+    alignas(64) float velocity[BATCH];
+    alignas(64) float water[BATCH];
+    alignas(64) float sediment[BATCH];
+    uint32_t alive;  // bit i: lane i still in the map
+};
+
+/** Height changes of one step, applied lane by lane after all lanes read. */
+struct BatchDeltas {
+    alignas(64) int idx[BATCH];
+    alignas(64) float nw[BATCH];
+    alignas(64) float ne[BATCH];
+    alignas(64) float sw[BATCH];
+    alignas(64) float se[BATCH];
 };
 
+/** Droplet count for a map: cfg.droplets, or scaled with area when 0. */
+inline int droplet_count(const Config::ErosionConfig& cfg, int H, int W) {
+    if (cfg.droplets > 0) {
+        return cfg.droplets;
+    }
+    return static_cast<int>(std::llround(50000.0 * H * W / (4096.0 * 4096.0)));
+}
+
+/** @brief Droplet erosion with the parameters of a Config::ErosionConfig. */
 class ErosionSimulator {
    public:
-    const int numIterations = 50000;
-    const int maxLifetime = 30;
-    const float inertia = 0.05f;
-    const float sedimentCapacityFactor = 4.0f;
-    const float minSlope = 0.01f;
-    const float erodeSpeed = 0.3f;
-    const float depositSpeed = 0.3f;
-    const float evaporateSpeed = 0.01f;
-    const float gravity = 4.0f;
-    const float initialWater = 1.0f;
-    const float initialSpeed = 1.0f;
+    const int numIterations;
+    const int maxLifetime;
+    const float inertia;
+    const float sedimentCapacityFactor;
+    const float minSlope;
+    const float erodeSpeed;
+    const float depositSpeed;
+    const float evaporateSpeed;
+    const float gravity;
+    const float initialWater;
+    const float initialSpeed;
+
+    ErosionSimulator(const Config::ErosionConfig& cfg, int H, int W)
+        : numIterations(droplet_count(cfg, H, W)),
+          maxLifetime(cfg.max_lifetime),
+          inertia(cfg.inertia),
+          sedimentCapacityFactor(cfg.sediment_capacity),
+          minSlope(cfg.min_slope),
+          erodeSpeed(cfg.erode_speed),
+          depositSpeed(cfg.deposit_speed),
+          evaporateSpeed(cfg.evaporate_speed),
+          gravity(cfg.gravity),
+          initialWater(cfg.initial_water),
+          initialSpeed(cfg.initial_speed) {}
+
+    /**
+     * Order in which droplets run. Both give the same result for any thread
+     * count and differ from the one-droplet-at-a-time reference only where
+     * droplets cross paths.
+     *
+     * - Serial: batches in generation order on one thread. Within the
+     *   validator tolerance (about 0.02% of bytes off by more than 1).
+     * - Strips: droplets are bucketed by starting row into strips taller
+     *   than two droplet lifetimes. A droplet moves at most one pixel per
+     *   step, so strips two apart never touch the same cells; the even
+     *   strips run in parallel, then the odd ones. The reordering moves
+     *   about 0.2% of bytes, beyond the validator, so it is opt-in.
+     */
+    enum class Schedule { Serial, Strips };
+    Schedule schedule = Schedule::Serial;
 
     void erode(std::vector<float>& map, int H, int W, uint64_t seed) {
         XorShift64 rng(seed);
+        std::vector<float> startX(numIterations), startY(numIterations);
+        for (int i = 0; i < numIterations; ++i) {
+            startX[i] = static_cast<float>(rng.uniform_double() * (W - 1));
+            startY[i] = static_cast<float>(rng.uniform_double() * (H - 1));
+        }
+        const bool simd = __builtin_cpu_supports("avx512f");
+
+        if (schedule == Schedule::Serial) {
+            std::vector<int> order(numIterations);
+            std::iota(order.begin(), order.end(), 0);
+            run(map.data(), H, W, startX.data(), startY.data(), order, simd);
+            return;
+        }
 
+        const int strip_rows = 2 * (maxLifetime + 2);
+        const int strips = (H + strip_rows - 1) / strip_rows;
+        std::vector<std::vector<int>> members(strips);
         for (int i = 0; i < numIterations; ++i) {
-            Droplet droplet = {
-                .posX = static_cast<float>(rng.uniform_double() * (W - 1)),
-                .posY = static_cast<float>(rng.uniform_double() * (H - 1)),
-                .dirX = 0,
-                .dirY = 0,
-                .velocity = initialSpeed,
-                .water = initialWater,
-                .sediment = 0};
-
-            for (int j = 0; j < maxLifetime; ++j) {
-                int nodeX = static_cast<int>(droplet.posX);
-                int nodeY = static_cast<int>(droplet.posY);
-
-                if (nodeX < 0 || nodeX >= W - 1 || nodeY < 0 ||
-                    nodeY >= H - 1) {
-                    break;
-                }
+            members[static_cast<int>(startY[i]) / strip_rows].push_back(i);
+        }
+        for (int phase = 0; phase < 2; ++phase) {
+#pragma omp parallel for schedule(dynamic, 1)
+            for (int s = phase; s < strips; s += 2) {
+                run(map.data(), H, W, startX.data(), startY.data(), members[s], simd);
+            }
+        }
+    }
 
-                float u = droplet.posX - nodeX;
-                float v = droplet.posY - nodeY;
-                int idx = nodeY * W + nodeX;
-                float height_NW = map[idx];
-                float height_NE = map[idx + 1];
-                float height_SW = map[idx + W];
-                float height_SE = map[idx + W + 1];
-                float gradX = (height_NE - height_NW) * (1 - v) +
-                              (height_SE - height_SW) * v;
-                float gradY = (height_SW - height_NW) * (1 - u) +
-                              (height_SE - height_NE) * u;
-
-                droplet.dirX = (droplet.dirX * inertia - gradX * (1 - inertia));
-                droplet.dirY = (droplet.dirY * inertia - gradY * (1 - inertia));
-
-                float len = std::sqrt(droplet.dirX * droplet.dirX +
-                                      droplet.dirY * droplet.dirY);
-                if (len > 1e-6f) {
-                    droplet.dirX /= len;
-                    droplet.dirY /= len;
-                }
-                droplet.velocity =
-                    std::sqrt(droplet.velocity * droplet.velocity +
-                              std::abs(gradY) * gravity);  // Simplified physics
-
-                float sedimentCapacity = std::max(-gradY, minSlope) *
-                                         droplet.velocity * droplet.water *
-                                         sedimentCapacityFactor;
-
-                if (droplet.sediment > sedimentCapacity || gradY > 0) {
-                    float amountToDeposit =
-                        (gradY > 0) ? std::min(droplet.sediment, depositSpeed)
-                                    : (droplet.sediment - sedimentCapacity) *
-                                          depositSpeed;
-                    droplet.sediment -= amountToDeposit;
-
-                    map[idx] += amountToDeposit * (1 - u) * (1 - v);
-                    map[idx + 1] += amountToDeposit * u * (1 - v);
-                    map[idx + W] += amountToDeposit * (1 - u) * v;
-                    map[idx + W + 1] += amountToDeposit * u * v;
+   private:
+    /** Runs the droplets `ids`, BATCH at a time in the given order. */
+    void run(float* map, int H, int W, const float* startX, const float* startY,
+             const std::vector<int>& ids, bool simd) const {
+        DropletBatch b;
+        BatchDeltas d;
+        for (size_t first = 0; first < ids.size(); first += BATCH) {
+            const int n = static_cast<int>(std::min<size_t>(BATCH, ids.size() - first));
+            for (int l = 0; l < BATCH; ++l) {
+                const int id = ids[first + std::min(l, n - 1)];
+                b.posX[l] = startX[id];
+                b.posY[l] = startY[id];
+                b.dirX[l] = b.dirY[l] = 0;
+                b.velocity[l] = initialSpeed;
+                b.water[l] = initialWater;
+                b.sediment[l] = 0;
+            }
+            b.alive = (1u << n) - 1;
+            for (int j = 0; j < maxLifetime && b.alive; ++j) {
+                if (simd) {
+                    step_avx512(map, H, W, b, d);
                 } else {
-                    float amountToErode = std::min(
-                        (sedimentCapacity - droplet.sediment) * erodeSpeed,
-                        -gradY);
-
-                    float w_nw = (1 - u) * (1 - v);
-                    float w_ne = u * (1 - v);
-                    float w_sw = (1 - u) * v;
-                    float w_se = u * v;
-                    map[idx] -= amountToErode * w_nw;
-                    map[idx + 1] -= amountToErode * w_ne;
-                    map[idx + W] -= amountToErode * w_sw;
-                    map[idx + W + 1] -= amountToErode * w_se;
-                    droplet.sediment += amountToErode;
+                    step_lanes(map, H, W, b, d);
                 }
+                for (int l = 0; l < BATCH; ++l) {
+                    if (b.alive >> l & 1) {
+                        float* cell = map + d.idx[l];
+                        cell[0] += d.nw[l];
+                        cell[1] += d.ne[l];
+                        cell[W] += d.sw[l];
+                        cell[W + 1] += d.se[l];
+                    }
+                }
+            }
+        }
+    }
 
-                droplet.posX += droplet.dirX;
-                droplet.posY += droplet.dirY;
-                droplet.water *= (1 - evaporateSpeed);
+    /**
+     * One step of every live lane, with the reference's operations in the
+     * reference's order. Lanes leaving the map drop out of b.alive.
+     */
+    void step_lanes(const float* map, int H, int W, DropletBatch& b,
+                    BatchDeltas& d) const {
+        for (int l = 0; l < BATCH; ++l) {
+            if (!(b.alive >> l & 1)) {
+                continue;
             }
+            const int nodeX = static_cast<int>(b.posX[l]);
+            const int nodeY = static_cast<int>(b.posY[l]);
+            if (nodeX < 0 || nodeX >= W - 1 || nodeY < 0 || nodeY >= H - 1) {
+                b.alive &= ~(1u << l);
+                continue;
+            }
+            const float u = b.posX[l] - nodeX;
+            const float v = b.posY[l] - nodeY;
+            const int idx = nodeY * W + nodeX;
+            const float height_NW = map[idx];
+            const float height_NE = map[idx + 1];
+            const float height_SW = map[idx + W];
+            const float height_SE = map[idx + W + 1];
+            const float gradX = (height_NE - height_NW) * (1 - v) +
+                                (height_SE - height_SW) * v;
+            const float gradY = (height_SW - height_NW) * (1 - u) +
+                                (height_SE - height_NE) * u;
+
+            float dirX = b.dirX[l] * inertia - gradX * (1 - inertia);
+            float dirY = b.dirY[l] * inertia - gradY * (1 - inertia);
+            const float len = std::sqrt(dirX * dirX + dirY * dirY);
+            if (len > 1e-6f) {
+                dirX /= len;
+                dirY /= len;
+            }
+            const float velocity =
+                std::sqrt(b.velocity[l] * b.velocity[l] + std::abs(gradY) * gravity);
+            const float sedimentCapacity = std::max(-gradY, minSlope) * velocity *
+                                           b.water[l] * sedimentCapacityFactor;
+
+            float sediment = b.sediment[l];
+            d.idx[l] = idx;
+            if (sediment > sedimentCapacity || gradY > 0) {
+                const float amountToDeposit =
+                    (gradY > 0) ? std::min(sediment, depositSpeed)
+                                : (sediment - sedimentCapacity) * depositSpeed;
+                sediment -= amountToDeposit;
+                d.nw[l] = amountToDeposit * (1 - u) * (1 - v);
+                d.ne[l] = amountToDeposit * u * (1 - v);
+                d.sw[l] = amountToDeposit * (1 - u) * v;
+                d.se[l] = amountToDeposit * u * v;
+            } else {
+                const float amountToErode =
+                    std::min((sedimentCapacity - sediment) * erodeSpeed, -gradY);
+                d.nw[l] = -(amountToErode * ((1 - u) * (1 - v)));
+                d.ne[l] = -(amountToErode * (u * (1 - v)));
+                d.sw[l] = -(amountToErode * ((1 - u) * v));
+                d.se[l] = -(amountToErode * (u * v));
+                sediment += amountToErode;
+            }
+
+            b.dirX[l] = dirX;
+            b.dirY[l] = dirY;
+            b.velocity[l] = velocity;
+            b.sediment[l] = sediment;
+            b.posX[l] += dirX;
+            b.posY[l] += dirY;
+            b.water[l] *= (1 - evaporateSpeed);
         }
     }
+
+    // Same as step_lanes() for all 16 lanes at once. fp-contract is off so
+    // no multiply-add is fused and both kernels round identically.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    __attribute__((target("avx512f"), optimize("fp-contract=off"))) void step_avx512(
+        const float* map, int H, int W, DropletBatch& b, BatchDeltas& d) const {
+        const __m512 one = _mm512_set1_ps(1.0f), zero = _mm512_setzero_ps();
+        const __m512 posX = _mm512_load_ps(b.posX), posY = _mm512_load_ps(b.posY);
+        const __m512i nodeX = _mm512_cvttps_epi32(posX);
+        const __m512i nodeY = _mm512_cvttps_epi32(posY);
+        __mmask16 m = static_cast<__mmask16>(b.alive);
+        m = _mm512_mask_cmpgt_epi32_mask(m, _mm512_set1_epi32(W - 1), nodeX);
+        m = _mm512_mask_cmpgt_epi32_mask(m, _mm512_set1_epi32(H - 1), nodeY);
+        m = _mm512_mask_cmpge_epi32_mask(m, nodeX, _mm512_setzero_si512());
+        m = _mm512_mask_cmpge_epi32_mask(m, nodeY, _mm512_setzero_si512());
+        b.alive = m;
+        if (!m) {
+            return;
+        }
+
+        const __m512 u = _mm512_sub_ps(posX, _mm512_cvtepi32_ps(nodeX));
+        const __m512 v = _mm512_sub_ps(posY, _mm512_cvtepi32_ps(nodeY));
+        const __m512i idx = _mm512_add_epi32(
+            _mm512_mullo_epi32(nodeY, _mm512_set1_epi32(W)), nodeX);
+        const __m512i vW = _mm512_set1_epi32(W), v1 = _mm512_set1_epi32(1);
+        const __m512 hNW = _mm512_mask_i32gather_ps(zero, m, idx, map, 4);
+        const __m512 hNE = _mm512_mask_i32gather_ps(zero, m, _mm512_add_epi32(idx, v1), map, 4);
+        const __m512 hSW = _mm512_mask_i32gather_ps(zero, m, _mm512_add_epi32(idx, vW), map, 4);
+        const __m512 hSE = _mm512_mask_i32gather_ps(
+            zero, m, _mm512_add_epi32(_mm512_add_epi32(idx, vW), v1), map, 4);
+        const __m512 iu = _mm512_sub_ps(one, u), iv = _mm512_sub_ps(one, v);
+        const __m512 gradX = _mm512_add_ps(_mm512_mul_ps(_mm512_sub_ps(hNE, hNW), iv),
+                                           _mm512_mul_ps(_mm512_sub_ps(hSE, hSW), v));
+        const __m512 gradY = _mm512_add_ps(_mm512_mul_ps(_mm512_sub_ps(hSW, hNW), iu),
+                                           _mm512_mul_ps(_mm512_sub_ps(hSE, hNE), u));
+
+        const __m512 in = _mm512_set1_ps(inertia), rest = _mm512_set1_ps(1 - inertia);
+        __m512 dirX = _mm512_sub_ps(_mm512_mul_ps(_mm512_load_ps(b.dirX), in),
+                                    _mm512_mul_ps(gradX, rest));
+        __m512 dirY = _mm512_sub_ps(_mm512_mul_ps(_mm512_load_ps(b.dirY), in),
+                                    _mm512_mul_ps(gradY, rest));
+        const __m512 len = _mm512_sqrt_ps(
+            _mm512_add_ps(_mm512_mul_ps(dirX, dirX), _mm512_mul_ps(dirY, dirY)));
+        const __mmask16 norm = _mm512_cmp_ps_mask(len, _mm512_set1_ps(1e-6f), _CMP_GT_OQ);
+        dirX = _mm512_mask_div_ps(dirX, norm, dirX, len);
+        dirY = _mm512_mask_div_ps(dirY, norm, dirY, len);
+
+        const __m512 absGradY = _mm512_castsi512_ps(_mm512_and_si512(
+            _mm512_castps_si512(gradY), _mm512_set1_epi32(0x7fffffff)));
+        const __m512 vel0 = _mm512_load_ps(b.velocity);
+        const __m512 velocity = _mm512_sqrt_ps(_mm512_add_ps(
+            _mm512_mul_ps(vel0, vel0), _mm512_mul_ps(absGradY, _mm512_set1_ps(gravity))));
+        const __m512 negGradY = _mm512_sub_ps(zero, gradY);
+        const __m512 water = _mm512_load_ps(b.water);
+        // std::max(a, b) is (a < b) ? b : a, std::min(a, b) is (b < a) ? b : a
+        const __m512 slope = _mm512_mask_blend_ps(
+            _mm512_cmp_ps_mask(negGradY, _mm512_set1_ps(minSlope), _CMP_LT_OQ), negGradY,
+            _mm512_set1_ps(minSlope));
+        const __m512 capacity = _mm512_mul_ps(
+            _mm512_mul_ps(_mm512_mul_ps(slope, velocity), water),
+            _mm512_set1_ps(sedimentCapacityFactor));
+
+        __m512 sediment = _mm512_load_ps(b.sediment);
+        const __mmask16 downhill = _mm512_cmp_ps_mask(gradY, zero, _CMP_GT_OQ);
+        const __mmask16 deposit =
+            downhill | _mm512_cmp_ps_mask(sediment, capacity, _CMP_GT_OQ);
+        const __m512 depSpeed = _mm512_set1_ps(depositSpeed);
+        const __m512 minSedSpeed = _mm512_mask_blend_ps(
+            _mm512_cmp_ps_mask(depSpeed, sediment, _CMP_LT_OQ), sediment, depSpeed);
+        const __m512 excess = _mm512_mul_ps(_mm512_sub_ps(sediment, capacity), depSpeed);
+        const __m512 toDeposit = _mm512_mask_blend_ps(downhill, excess, minSedSpeed);
+        const __m512 want = _mm512_mul_ps(_mm512_sub_ps(capacity, sediment),
+                                          _mm512_set1_ps(erodeSpeed));
+        const __m512 toErode = _mm512_mask_blend_ps(
+            _mm512_cmp_ps_mask(negGradY, want, _CMP_LT_OQ), want, negGradY);
+        sediment = _mm512_mask_blend_ps(deposit, _mm512_add_ps(sediment, toErode),
+                                        _mm512_sub_ps(sediment, toDeposit));
+
+        // Deposit: amount * wu * wv; erode: -(amount * (wu * wv))
+        const __m512 wus[2] = {iu, u}, wvs[2] = {iv, v};
+        float* out[4] = {d.nw, d.ne, d.sw, d.se};
+        for (int c = 0; c < 4; ++c) {
+            const __m512 wu = wus[c & 1], wv = wvs[c >> 1];
+            const __m512 dep = _mm512_mul_ps(_mm512_mul_ps(toDeposit, wu), wv);
+            const __m512 ero = _mm512_sub_ps(zero, _mm512_mul_ps(toErode, _mm512_mul_ps(wu, wv)));
+            _mm512_store_ps(out[c], _mm512_mask_blend_ps(deposit, ero, dep));
+        }
+        _mm512_store_si512(d.idx, idx);
+
+        _mm512_mask_store_ps(b.dirX, m, dirX);
+        _mm512_mask_store_ps(b.dirY, m, dirY);
+        _mm512_mask_store_ps(b.velocity, m, velocity);
+        _mm512_mask_store_ps(b.sediment, m, sediment);
+        _mm512_mask_store_ps(b.posX, m, _mm512_add_ps(posX, dirX));
+        _mm512_mask_store_ps(b.posY, m, _mm512_add_ps(posY, dirY));
+        _mm512_mask_store_ps(b.water, m,
+                             _mm512_mul_ps(water, _mm512_set1_ps(1 - evaporateSpeed)));
+    }
+#pragma GCC diagnostic pop
 };
 
 }  // namespace Erosion
 
 void generate_terrain(uint8_t* height_map, const Config& cfg) {
     PerlinBaseline::PerlinNoiseGenerator generator(cfg.seeds.perlin);
-    const double SHAPING_EXPONENT = 1.5;
     PerlinBaseline::PerlinNoiseGenerator warp_generator(cfg.seeds.perlin + 1);
-    const double WARP_FREQUENCY = 0.005;
-    const double WARP_AMPLITUDE = 60.0;
+    const PerlinSimd::Octaves octaves(cfg.perlin);
+    const PerlinSimd::Isa isa = PerlinSimd::detect_isa();
 
     std::vector<float> float_map(static_cast<size_t>(cfg.H) * cfg.W);
 
-    for (int y = 0; y < cfg.H; ++y) {
-        for (int x = 0; x < cfg.W; ++x) {
-            double q1 =
-                warp_generator.noise(x * WARP_FREQUENCY, y * WARP_FREQUENCY);
-            double q2 = warp_generator.noise((x + 123.4) * WARP_FREQUENCY,
-                                             (y + 567.8) * WARP_FREQUENCY);
-            double warped_x =
-                static_cast<double>(x) + WARP_AMPLITUDE * (2.0 * q1 - 1.0);
-            double warped_y =
-                static_cast<double>(y) + WARP_AMPLITUDE * (2.0 * q2 - 1.0);
-
-            double total_noise = 0.0, amplitude = 1.0,
-                   frequency = cfg.perlin.base_freq, max_amplitude = 0.0;
-            for (int o = 0; o < cfg.perlin.octaves; ++o) {
-                total_noise += generator.noise(warped_x * frequency,
-                                               warped_y * frequency) *
-                               amplitude;
-                max_amplitude += amplitude;
-                amplitude *= cfg.perlin.persistence;
-                frequency *= cfg.perlin.lacunarity;
+    // Rows are independent and each one is computed the same way on any
+    // thread, so the output does not depend on the thread count
+#pragma omp parallel
+    {
+        PerlinSimd::WarpScanline warp_x(warp_generator, 0.0, 0.0, cfg.W);
+        PerlinSimd::WarpScanline warp_y(warp_generator, PerlinSimd::WARP_OFFSET_X,
+                                        PerlinSimd::WARP_OFFSET_Y, cfg.W);
+#pragma omp for schedule(static, PerlinSimd::ROWS_PER_TILE)
+        for (int y = 0; y < cfg.H; ++y) {
+            float* row = float_map.data() + static_cast<size_t>(y) * cfg.W;
+            if (isa == PerlinSimd::Isa::Scalar) {
+                PerlinSimd::terrain_row_scalar(generator, warp_generator, cfg.perlin, y,
+                                               cfg.W, row);
+                continue;
             }
-            if (max_amplitude > 0.0) {
-                total_noise /= max_amplitude;
+            warp_x.start(y);
+            warp_y.start(y);
+            if (isa == PerlinSimd::Isa::Avx512) {
+                PerlinSimd::terrain_row_avx512(generator.cell_codes(), warp_x, warp_y,
+                                               octaves, y, cfg.W, row);
+            } else {
+                PerlinSimd::terrain_row_avx2(generator.cell_codes(), warp_x, warp_y,
+                                             octaves, y, cfg.W, row);
             }
-            total_noise = std::max(0.0, std::min(1.0, total_noise));
-            total_noise = pow(total_noise, SHAPING_EXPONENT);
-            float_map[y * cfg.W + x] = static_cast<float>(total_noise);
         }
     }
 
-    Erosion::ErosionSimulator erosion_sim;
-    erosion_sim.erode(float_map, cfg.H, cfg.W, cfg.seeds.events);
+    Erosion::ErosionSimulator erosion_sim(cfg.erosion, cfg.H, cfg.W);
+    erosion_sim.schedule = cfg.perlin.erosion == Config::PerlinConfig::Erosion::DropletStrips
+                               ? Erosion::ErosionSimulator::Schedule::Strips
+                               : Erosion::ErosionSimulator::Schedule::Serial;
+    erosion_sim.erode(float_map, cfg.H, cfg.W, cfg.seeds.erosion);
 
     const float FIXED_MIN_H = 0.0f;
     const float FIXED_MAX_H = 1.0f;
     const float FIXED_RANGE = FIXED_MAX_H - FIXED_MIN_H;
 
+#pragma omp parallel for schedule(static)
     for (size_t i = 0; i < float_map.size(); ++i) {
         float normalized = (float_map[i] - FIXED_MIN_H) / FIXED_RANGE;
         height_map[i] = static_cast<uint8_t>(
             std::max(0.0f, std::min(normalized * 255.0f, 255.0f)));
     }
 }
-
@@ -2,8 +2,15 @@
  * @file harness_splat.cpp
  * @brief The main test harness for the event splatting optimization problem.
  *
+ * Optional arguments:
+ *   --visualize
+ *   --input-heightmap <file.raw>
+ *   --output-damage-raw <file.raw>
+ *   --output-occlusion-raw <file.raw>
+ *   --threads <n>                      (OpenMP threads, to measure scaling)
  */
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -11,6 +18,10 @@
 #include <string>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "../framework/hash.h"
 #include "../framework/ppm_writer.h"
 #include "../framework/timer.h"
@@ -61,6 +72,16 @@ int main(int argc, char* argv[]) {
             damage_output_filename = argv[++i];
         } else if (arg == "--output-occlusion-raw" && i + 1 < argc) {
             occlusion_output_filename = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            const int threads = std::max(1, std::stoi(argv[++i]));
+#ifdef _OPENMP
+            omp_set_num_threads(threads);
+#else
+            if (threads > 1) {
+                std::cerr << "Warning: built without OpenMP, --threads ignored"
+                          << std::endl;
+            }
+#endif
         }
     }
 
@@ -1,36 +1,451 @@
 /**
- * @file baseline_splat.cpp
- * @brief Reference implementation used for benchmarking and validation.
+ * @file submit_splat.cpp
+ * @brief Optimised event splatting: events binned by screen tile.
  *
- * Kept immutable to provide a stable baseline. Contestants should optimize
- * `submit_splat.cpp` and compare against this file using the provided tools.
+ * splat_build_events() also sorts the events into 64 x 64 pixel tiles; an
+ * event goes into every tile its bounding box overlaps, and each tile's list
+ * keeps generation order. splat_apply() then runs tile by tile, so the
+ * damage, occlusion and height rows of one tile (12 KB) stay in L1/L2 while
+ * all of its events land, instead of every event touching a random part of
+ * the full-size maps. Each pixel still receives its events in generation
+ * order, and every event computes exactly the baseline's values, so the
+ * saturating sums are bit-identical to baseline_splat.cpp. Tiles are
+ * independent, so they are spread over OpenMP threads and the output is the
+ * same for any thread count.
+ *
+ * Bomb damage is read from a table of dist_sq thresholds per damage level
+ * (DamageLevels) instead of calling expf / sqrtf and round per pixel, and
+ * height attenuation is an exact integer multiply-shift (HeightAttenuation).
+ *
+ * Events are stored one array per field, bombs first, with their bounding
+ * boxes and inverse squared radii computed once at generation. Generation
+ * runs in chunks, each starting from a jump-ahead of the event seed.
  */
 
+#include <immintrin.h>
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
 #include <vector>
 
 #include "../framework/prng.h"
 #include "../framework/types.h"
 
+// The Makefile builds with -march=native; the span kernel needs AVX-512BW
+// for byte masks and falls back to scalar code elsewhere
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__)
+#define SPLAT_AVX512 1
+#endif
+
+/**
+ * @brief Bomb damage round(intensity * falloff(dist_sq)) as thresholds.
+ *
+ * The damage is non-increasing in dist_sq (sqrtf is correctly rounded and
+ * glibc's expf was checked for every float in [0, 1]), so it equals the
+ * number of levels k whose limit, the largest dist_sq with damage >= k, is
+ * >= dist_sq. Limits are found by bisection over float bit patterns with the
+ * baseline's own expression, so the table is exact. damage() starts from
+ * the level at the start of dist_sq's 1/1024 slice and steps down past at
+ * most max_steps() limits.
+ */
+class DamageLevels {
+   public:
+    static const int SLICES = 1024;
+
+    DamageLevels() = default;
+    DamageLevels(float intensity, bool gaussian) : intensity_(intensity), gaussian_(gaussian) {
+        const int top = exact(0.0f);
+        // Level 0 never steps down
+        limit_.push_back(std::numeric_limits<float>::infinity());
+        for (int k = 1; k <= top; ++k) {
+            uint32_t lo = 0, hi = bits(1.0f);  // exact(lo) >= k
+            while (lo < hi) {
+                const uint32_t mid = lo + (hi - lo + 1) / 2;
+                if (exact(from_bits(mid)) >= k) {
+                    lo = mid;
+                } else {
+                    hi = mid - 1;
+                }
+            }
+            limit_.push_back(from_bits(lo));
+        }
+        slice_level_.resize(SLICES + 1);
+        for (int b = 0; b <= SLICES; ++b) {
+            slice_level_[b] = exact(static_cast<float>(b) / SLICES);
+            if (b > 0) {
+                max_steps_ = std::max(max_steps_, slice_level_[b - 1] - slice_level_[b]);
+            }
+        }
+    }
+
+    /** Damage for 0 <= dist_sq <= 1. */
+    int damage(float dist_sq) const {
+        int level = slice_level_[static_cast<int>(dist_sq * SLICES)];
+        while (dist_sq > limit_[level]) {
+            --level;
+        }
+        return level;
+    }
+
+    /** The baseline's expression. */
+    int exact(float dist_sq) const {
+        if (gaussian_) {
+            return static_cast<int>(std::round(intensity_ * expf(-3.0f * dist_sq)));
+        }
+        return static_cast<int>(std::round(intensity_ * (1.0f - sqrtf(dist_sq))));
+    }
+
+    /** Tables for vector lookups: level at each slice start, limit per level. */
+    const int32_t* slice_levels() const { return slice_level_.data(); }
+    const float* limits() const { return limit_.data(); }
+    int max_steps() const { return max_steps_; }
+
+   private:
+    static uint32_t bits(float f) {
+        uint32_t u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+    static float from_bits(uint32_t u) {
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+
+    float intensity_ = 0.0f;
+    bool gaussian_ = true;
+    std::vector<float> limit_;  // limit_[k]: largest dist_sq with damage >= k
+    std::vector<int32_t> slice_level_;
+    int max_steps_ = 0;
+};
+
+/**
+ * @brief Height attenuation (int)(damage * (1 - h / 255 * 0.8f)) in fixed point.
+ *
+ * For every damage in [0, MAX_DAMAGE] and every u8 height,
+ * (damage * scale(h)) >> SHIFT equals the baseline's float expression. Each
+ * damage d >= 1 confines scale(h) to an interval of multipliers; the table
+ * holds the smallest one in all of them. Bombs reach at most their
+ * intensity and bullets add round(10.0f), so MAX_DAMAGE = 40 covers both.
+ * No affine function of h fits every interval, hence the table; its entries
+ * are at most 1 << SHIFT, so they fit in 16 bits.
+ */
+class HeightAttenuation {
+   public:
+    static const int SHIFT = 15;
+    static const int MAX_DAMAGE = 40;
+
+    HeightAttenuation() : scale_(256) {
+        for (int h = 0; h < 256; ++h) {
+            int64_t lo = 0, hi = std::numeric_limits<int64_t>::max();
+            for (int d = 1; d <= MAX_DAMAGE; ++d) {
+                // t << SHIFT <= d * scale < (t + 1) << SHIFT
+                const int64_t t = exact(d, static_cast<uint8_t>(h));
+                lo = std::max(lo, ((t << SHIFT) + d - 1) / d);
+                hi = std::min(hi, (((t + 1) << SHIFT) - 1) / d);
+            }
+            scale_[h] = static_cast<uint16_t>(lo <= hi ? lo : 0);
+        }
+    }
+
+    /** Attenuated damage for 0 <= damage <= MAX_DAMAGE. */
+    int apply(int damage, uint8_t h) const { return (damage * scale_[h]) >> SHIFT; }
+
+    /** The baseline's expression. */
+    static int exact(int damage, uint8_t h) {
+        const float attenuation_factor = 1.0f - (static_cast<float>(h) / 255.0f) * 0.8f;
+        return static_cast<int>(static_cast<float>(damage) * attenuation_factor);
+    }
+
+    /** Multiplier per height, for vector lookups. */
+    const uint16_t* scales() const { return scale_.data(); }
+
+   private:
+    std::vector<uint16_t> scale_;
+};
+
 struct SplatContext {
-    struct Event {
-        float x, y;
-        float rx, ry;
-        float intensity;
-        uint8_t type;  // 0: bullet, 1: bomb
-    };
-    std::vector<Event> events;
+    /**
+     * Events in generation order, one array per field. Bombs are
+     * [0, num_bombs) and bullets [num_bombs, num_events), so an event's type
+     * and intensity follow from its index.
+     */
+    int num_events = 0, num_bombs = 0;
+    std::vector<float> x, y, rx, ry;
+    /** 1 / (r * r + 1e-6f), as the baseline computes it per event. */
+    std::vector<float> inv_rx_sq, inv_ry_sq;
+    /** Inclusive pixel bounding boxes, clamped to the map. */
+    std::vector<int32_t> x_min, x_max, y_min, y_max;
+
+    static constexpr float BOMB_INTENSITY = 40.0f;
+    static constexpr float BULLET_INTENSITY = 10.0f;
+
+    /** Tile side in pixels. */
+    static const int TILE = 64;
+    int tiles_x = 0, tiles_y = 0;
+    /** Events of tile t are tile_events[tile_start[t] .. tile_start[t + 1]). */
+    std::vector<uint32_t> tile_start;
+    std::vector<uint32_t> tile_events;
+
+    /** Damage table of the bombs. */
+    DamageLevels bomb_levels;
+    /** Bullet damage before attenuation, round(BULLET_INTENSITY). */
+    int bullet_damage = 0;
+    HeightAttenuation attenuation;
 };
 
-static inline uint8_t saturating_add_u8(uint8_t a, int b) {
+namespace {
+
+inline uint8_t saturating_add_u8(uint8_t a, int b) {
     int sum = static_cast<int>(a) + b;
     if (sum > 255) return 255;
     if (sum < 0) return 0;
     return static_cast<uint8_t>(sum);
 }
 
+/** What an event adds at each covered pixel, before height attenuation. */
+struct SpanDamage {
+    const DamageLevels* levels;  // bombs; nullptr for bullets
+    int damage;                  // bullets
+    int occlusion;               // bullets; bombs add 2 where damage > 0
+    const HeightAttenuation* attenuation;
+};
+
+#ifndef SPLAT_AVX512
+/** Pixels [0, n) of a row span, all inside the ellipse; dx per pixel. */
+void splat_span_scalar(const float* dx, int n, float ky, float inv_rx_sq, const SpanDamage& sd,
+                       uint8_t* damage_row, uint8_t* occlusion_row, const uint8_t* height_row) {
+    for (int i = 0; i < n; ++i) {
+        int damage_add = sd.damage;
+        int occlusion_add = sd.occlusion;
+        if (sd.levels) {
+            const float dist_sq = (dx[i] * dx[i]) * inv_rx_sq + ky;
+            damage_add = sd.levels->damage(dist_sq);
+            occlusion_add = (damage_add > 0) ? 2 : 0;
+        }
+        damage_add = sd.attenuation->apply(damage_add, height_row[i]);
+        damage_row[i] = saturating_add_u8(damage_row[i], damage_add);
+        occlusion_row[i] = saturating_add_u8(occlusion_row[i], occlusion_add);
+    }
+}
+#else
+// GCC 12's AVX-512 headers trip -Wmaybe-uninitialized on masked intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+/** The 256 attenuation scales as eight registers of 32 words. */
+struct ScaleTable {
+    __m512i part[8];
+
+    explicit ScaleTable(const HeightAttenuation& attenuation) {
+        for (int k = 0; k < 8; ++k) {
+            part[k] = _mm512_loadu_si512(attenuation.scales() + 32 * k);
+        }
+    }
+};
+
+/**
+ * HeightAttenuation::apply() on 16 dword lanes, damage in [0, MAX_DAMAGE]
+ * and h in [0, 255]. Each vpermt2w looks up 64 scales by the low word of
+ * every lane and bits 6 and 7 of h pick the result. The high words pick up
+ * junk, but the damage's high words are zero, so vpmulhuw
+ * ((2 * damage) * scale) >> 16 leaves exactly (damage * scale) >> 15.
+ */
+inline __m512i attenuate_avx512(__m512i damage, __m512i h, const ScaleTable& table) {
+    static_assert(HeightAttenuation::SHIFT == 15, "vpmulhuw shifts by 16");
+    const __m512i* t = table.part;
+    const __mmask16 bit6 = _mm512_test_epi32_mask(h, _mm512_set1_epi32(64));
+    const __mmask16 bit7 = _mm512_test_epi32_mask(h, _mm512_set1_epi32(128));
+    const __m512i low = _mm512_mask_blend_epi32(bit6, _mm512_permutex2var_epi16(t[0], h, t[1]),
+                                                _mm512_permutex2var_epi16(t[2], h, t[3]));
+    const __m512i high = _mm512_mask_blend_epi32(bit6, _mm512_permutex2var_epi16(t[4], h, t[5]),
+                                                 _mm512_permutex2var_epi16(t[6], h, t[7]));
+    const __m512i scale = _mm512_mask_blend_epi32(bit7, low, high);
+    return _mm512_mulhi_epu16(_mm512_slli_epi32(damage, 1), scale);
+}
+
+/**
+ * splat_span_scalar() 16 pixels at a time. Every float operation is the
+ * baseline's, in its order and unfused (no FMA), the attenuation is the same
+ * integer multiply-shift, and the damage is at most 40, so the u8 saturating
+ * adds match saturating_add_u8().
+ */
+void splat_span_avx512(const float* dx, int n, float ky, float inv_rx_sq, const SpanDamage& sd,
+                       const ScaleTable& table, uint8_t* damage_row, uint8_t* occlusion_row,
+                       const uint8_t* height_row) {
+    const __m512i zero = _mm512_setzero_si512();
+    for (int i = 0; i < n; i += 16) {
+        const __mmask16 m = n - i >= 16 ? 0xffff : static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512i damage = _mm512_set1_epi32(sd.damage);
+        __m512i occlusion = _mm512_set1_epi32(sd.occlusion);
+        if (sd.levels) {
+            const __m512 d = _mm512_maskz_loadu_ps(m, dx + i);
+            const __m512 dist_sq = _mm512_add_ps(
+                _mm512_mul_ps(_mm512_mul_ps(d, d), _mm512_set1_ps(inv_rx_sq)), _mm512_set1_ps(ky));
+            const __m512i slice = _mm512_cvttps_epi32(
+                _mm512_mul_ps(dist_sq, _mm512_set1_ps(static_cast<float>(DamageLevels::SLICES))));
+            damage = _mm512_mask_i32gather_epi32(zero, m, slice, sd.levels->slice_levels(), 4);
+            for (int k = 0; k < sd.levels->max_steps(); ++k) {
+                const __m512 limit = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), m, damage,
+                                                              sd.levels->limits(), 4);
+                const __mmask16 past = _mm512_mask_cmp_ps_mask(m, dist_sq, limit, _CMP_GT_OQ);
+                damage = _mm512_mask_sub_epi32(damage, past, damage, _mm512_set1_epi32(1));
+            }
+            occlusion = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(damage, zero),
+                                               _mm512_set1_epi32(2));
+        }
+        const __m512i h = _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(m, height_row + i));
+        damage = attenuate_avx512(damage, h, table);
+
+        const __m128i dm = _mm_maskz_loadu_epi8(m, damage_row + i);
+        _mm_mask_storeu_epi8(damage_row + i, m, _mm_adds_epu8(dm, _mm512_cvtepi32_epi8(damage)));
+        const __m128i om = _mm_maskz_loadu_epi8(m, occlusion_row + i);
+        _mm_mask_storeu_epi8(occlusion_row + i, m,
+                             _mm_adds_epu8(om, _mm512_cvtepi32_epi8(occlusion)));
+    }
+}
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * Splats the part of event `e` inside columns [x_lo, x_hi] (at most one tile
+ * wide) and rows [y_lo, y_hi], which must lie within its bounding box.
+ *
+ * The baseline steps dx by +1.0f from x_min; the row's dx values are built
+ * by the same additions, so every pixel sees the same rounding. dist_sq
+ * falls and then rises along a row, so the covered pixels are one span: it
+ * is estimated from the ellipse equation and then moved to the exact
+ * boundary with the baseline's dist_sq <= 1 test, a few evaluations per row.
+ */
+void splat_event_rect(const SplatContext& ctx, uint32_t e, int x_lo, int x_hi, int y_lo, int y_hi,
+                      uint8_t* damage_map, uint8_t* occlusion_map, const uint8_t* height_map,
+                      const Config& cfg) {
+    const float ex = ctx.x[e], ey = ctx.y[e], erx = ctx.rx[e];
+    const float inv_rx_sq = ctx.inv_rx_sq[e];
+    const float inv_ry_sq = ctx.inv_ry_sq[e];
+
+    SpanDamage sd = {nullptr, ctx.bullet_damage, 1, &ctx.attenuation};
+    if (e < static_cast<uint32_t>(ctx.num_bombs)) {
+        sd.levels = &ctx.bomb_levels;
+    }
+#ifdef SPLAT_AVX512
+    const ScaleTable table(ctx.attenuation);
+#endif
+
+    const int n = x_hi - x_lo + 1;
+    float dx[SplatContext::TILE + 16];
+    float d = (static_cast<float>(ctx.x_min[e]) + 0.5f) - ex;
+    for (int x = ctx.x_min[e]; x < x_lo; ++x) {
+        d += 1.0f;
+    }
+    // Pixel nearest the centre: the smallest dist_sq on every row
+    int centre = 0;
+    for (int i = 0; i < n; ++i, d += 1.0f) {
+        dx[i] = d;
+        if (std::abs(d) < std::abs(dx[centre])) {
+            centre = i;
+        }
+    }
+
+    for (int y = y_lo; y <= y_hi; ++y) {
+        const float dy = (static_cast<float>(y) + 0.5f) - ey;
+        const float ky = (dy * dy) * inv_ry_sq;
+        auto inside = [&](int i) { return (dx[i] * dx[i]) * inv_rx_sq + ky <= 1.0f; };
+        if (!inside(centre)) {
+            continue;
+        }
+        // Estimate: |dx| <= rx * sqrt(1 - ky), kept around the centre
+        const float half = erx * std::sqrt(std::max(0.0f, 1.0f - ky));
+        int lo = std::min(centre, std::max(0, static_cast<int>(std::ceil(-half - dx[0]))));
+        int hi = std::max(centre, std::min(n - 1, static_cast<int>(std::floor(half - dx[0]))));
+        while (lo > 0 && inside(lo - 1)) --lo;
+        while (!inside(lo)) ++lo;
+        while (hi < n - 1 && inside(hi + 1)) ++hi;
+        while (!inside(hi)) --hi;
+
+        const size_t row = static_cast<size_t>(y) * cfg.W + x_lo + lo;
+#ifdef SPLAT_AVX512
+        splat_span_avx512(dx + lo, hi - lo + 1, ky, inv_rx_sq, sd, table, damage_map + row,
+                          occlusion_map + row, height_map + row);
+#else
+        splat_span_scalar(dx + lo, hi - lo + 1, ky, inv_rx_sq, sd, damage_map + row,
+                          occlusion_map + row, height_map + row);
+#endif
+    }
+}
+
+/**
+ * Fills events [first, first + count) of ctx, drawing r from [r_min, r_max].
+ * Event i takes calls 4i .. 4i + 3 of the generator (x, y, rx, ry), so each
+ * chunk starts from its own jump() of the seed state and the chunks fill in
+ * parallel with the serial sequence's values.
+ */
+void generate_events(SplatContext* ctx, int first, int count, int r_min, int r_max,
+                     const Config& cfg) {
+    const int CHUNK = 8192;
+    const int chunks = (count + CHUNK - 1) / CHUNK;
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int c = 0; c < chunks; ++c) {
+        const int begin = first + c * CHUNK;
+        const int end = first + std::min(count, (c + 1) * CHUNK);
+        XorShift64 rng(cfg.seeds.events);
+        rng.jump(4 * static_cast<uint64_t>(begin));
+        for (int i = begin; i < end; ++i) {
+            const float x = static_cast<float>(rng.uniform_double() * (cfg.W - 1));
+            const float y = static_cast<float>(rng.uniform_double() * (cfg.H - 1));
+            const float rx = static_cast<float>(rng.uniform_int(r_min, r_max));
+            const float ry = static_cast<float>(rng.uniform_int(r_min, r_max));
+            ctx->x[i] = x;
+            ctx->y[i] = y;
+            ctx->rx[i] = rx;
+            ctx->ry[i] = ry;
+            ctx->inv_rx_sq[i] = 1.0f / (rx * rx + 1e-6f);
+            ctx->inv_ry_sq[i] = 1.0f / (ry * ry + 1e-6f);
+            ctx->x_min[i] = static_cast<int>(std::max(0.0f, std::floor(x - rx)));
+            ctx->x_max[i] = static_cast<int>(std::min(static_cast<float>(cfg.W - 1), std::ceil(x + rx)));
+            ctx->y_min[i] = static_cast<int>(std::max(0.0f, std::floor(y - ry)));
+            ctx->y_max[i] = static_cast<int>(std::min(static_cast<float>(cfg.H - 1), std::ceil(y + ry)));
+        }
+    }
+}
+
+/** Counting sort of the events into the tiles their bounding boxes overlap. */
+void bin_events(SplatContext* ctx, const Config& cfg) {
+    const int T = SplatContext::TILE;
+    ctx->tiles_x = (cfg.W + T - 1) / T;
+    ctx->tiles_y = (cfg.H + T - 1) / T;
+    const size_t tiles = static_cast<size_t>(ctx->tiles_x) * ctx->tiles_y;
+
+    std::vector<uint32_t> count(tiles + 1, 0);
+    for (int i = 0; i < ctx->num_events; ++i) {
+        for (int ty = ctx->y_min[i] / T; ty <= ctx->y_max[i] / T; ++ty) {
+            for (int tx = ctx->x_min[i] / T; tx <= ctx->x_max[i] / T; ++tx) {
+                ++count[static_cast<size_t>(ty) * ctx->tiles_x + tx];
+            }
+        }
+    }
+    ctx->tile_start.assign(tiles + 1, 0);
+    for (size_t t = 0; t < tiles; ++t) {
+        ctx->tile_start[t + 1] = ctx->tile_start[t] + count[t];
+    }
+    ctx->tile_events.resize(ctx->tile_start[tiles]);
+    std::copy(ctx->tile_start.begin(), ctx->tile_start.end() - 1, count.begin());
+    for (int i = 0; i < ctx->num_events; ++i) {
+        for (int ty = ctx->y_min[i] / T; ty <= ctx->y_max[i] / T; ++ty) {
+            for (int tx = ctx->x_min[i] / T; tx <= ctx->x_max[i] / T; ++tx) {
+                ctx->tile_events[count[static_cast<size_t>(ty) * ctx->tiles_x + tx]++] =
+                    static_cast<uint32_t>(i);
+            }
+        }
+    }
+}
+
+}  // namespace
+
 SplatContext* splat_create(const Config& cfg) {
     (void)cfg;
     auto* ctx = new SplatContext();
@@ -38,75 +453,42 @@ SplatContext* splat_create(const Config& cfg) {
 }
 
 void splat_build_events(SplatContext* ctx, const Config& cfg) {
-    ctx->events.clear();
-    ctx->events.reserve(static_cast<size_t>(cfg.bombs.count + cfg.bullets.count));
-
-    XorShift64 rng(cfg.seeds.events);
-
-    for (int i = 0; i < cfg.bombs.count; ++i) {
-        ctx->events.push_back({static_cast<float>(rng.uniform_double() * (cfg.W - 1)),
-                               static_cast<float>(rng.uniform_double() * (cfg.H - 1)),
-                               static_cast<float>(rng.uniform_int(cfg.bombs.r_min, cfg.bombs.r_max)),
-                               static_cast<float>(rng.uniform_int(cfg.bombs.r_min, cfg.bombs.r_max)),
-                               40.0f, 1});
+    ctx->num_bombs = cfg.bombs.count;
+    ctx->num_events = cfg.bombs.count + cfg.bullets.count;
+    const size_t n = static_cast<size_t>(ctx->num_events);
+    for (auto* v : {&ctx->x, &ctx->y, &ctx->rx, &ctx->ry, &ctx->inv_rx_sq, &ctx->inv_ry_sq}) {
+        v->resize(n);
     }
-    for (int i = 0; i < cfg.bullets.count; ++i) {
-        ctx->events.push_back({static_cast<float>(rng.uniform_double() * (cfg.W - 1)),
-                               static_cast<float>(rng.uniform_double() * (cfg.H - 1)),
-                               static_cast<float>(rng.uniform_int(cfg.bullets.r_min, cfg.bullets.r_max)),
-                               static_cast<float>(rng.uniform_int(cfg.bullets.r_min, cfg.bullets.r_max)),
-                               10.0f, 0});
+    for (auto* v : {&ctx->x_min, &ctx->x_max, &ctx->y_min, &ctx->y_max}) {
+        v->resize(n);
     }
+
+    generate_events(ctx, 0, cfg.bombs.count, cfg.bombs.r_min, cfg.bombs.r_max, cfg);
+    generate_events(ctx, cfg.bombs.count, cfg.bullets.count, cfg.bullets.r_min,
+                    cfg.bullets.r_max, cfg);
+
+    bin_events(ctx, cfg);
+    ctx->bomb_levels = DamageLevels(SplatContext::BOMB_INTENSITY, cfg.bombs.gaussian);
+    ctx->bullet_damage = static_cast<int>(std::round(SplatContext::BULLET_INTENSITY));
 }
 
 void splat_apply(SplatContext* ctx, uint8_t* damage_map, uint8_t* occlusion_map,
                  const uint8_t* height_map, const Config& cfg) {
-    for (const auto& ev : ctx->events) {
-        const int x_min = static_cast<int>(std::max(0.0f, std::floor(ev.x - ev.rx)));
-        const int x_max =
-            static_cast<int>(std::min(static_cast<float>(cfg.W - 1), std::ceil(ev.x + ev.rx)));
-        const int y_min = static_cast<int>(std::max(0.0f, std::floor(ev.y - ev.ry)));
-        const int y_max =
-            static_cast<int>(std::min(static_cast<float>(cfg.H - 1), std::ceil(ev.y + ev.ry)));
-
-        const float inv_rx_sq = 1.0f / (ev.rx * ev.rx + 1e-6f);
-        const float inv_ry_sq = 1.0f / (ev.ry * ev.ry + 1e-6f);
-
-        for (int y = y_min; y <= y_max; ++y) {
-            const float dy = (static_cast<float>(y) + 0.5f) - ev.y;
-            const float ky = (dy * dy) * inv_ry_sq;
-
-            float dx = (static_cast<float>(x_min) + 0.5f) - ev.x;
-            int idx = y * cfg.W + x_min;
-
-            for (int x = x_min; x <= x_max; ++x, ++idx) {
-                const float dist_sq = (dx * dx) * inv_rx_sq + ky;
-
-                if (dist_sq <= 1.0f) {
-                    int damage_add = 0;
-                    int occlusion_add = 0;
-
-                    if (ev.type == 1) {
-                        if (cfg.bombs.gaussian) {
-                            damage_add = static_cast<int>(std::round(ev.intensity * expf(-3.0f * dist_sq)));
-                        } else {
-                            damage_add = static_cast<int>(std::round(ev.intensity * (1.0f - sqrtf(dist_sq))));
-                        }
-                        occlusion_add = (damage_add > 0) ? 2 : 0;
-                    } else {
-                        damage_add = static_cast<int>(std::round(ev.intensity));
-                        occlusion_add = 1;
-                    }
-
-                    const uint8_t h = height_map[idx];
-                    const float attenuation_factor = 1.0f - (static_cast<float>(h) / 255.0f) * 0.8f;
-                    damage_add = static_cast<int>(static_cast<float>(damage_add) * attenuation_factor);
-
-                    damage_map[idx] = saturating_add_u8(damage_map[idx], damage_add);
-                    occlusion_map[idx] = saturating_add_u8(occlusion_map[idx], occlusion_add);
-                }
-
-                dx += 1.0f;
+    const int T = SplatContext::TILE;
+    // Tiles share no pixels and each one applies its events in generation
+    // order, so they run in any order on any thread with the same result
+#pragma omp parallel for collapse(2) schedule(dynamic, 16)
+    for (int ty = 0; ty < ctx->tiles_y; ++ty) {
+        for (int tx = 0; tx < ctx->tiles_x; ++tx) {
+            const int tile_y0 = ty * T, tile_y1 = std::min(cfg.H, tile_y0 + T) - 1;
+            const int tile_x0 = tx * T, tile_x1 = std::min(cfg.W, tile_x0 + T) - 1;
+            const size_t t = static_cast<size_t>(ty) * ctx->tiles_x + tx;
+            for (uint32_t k = ctx->tile_start[t]; k < ctx->tile_start[t + 1]; ++k) {
+                const uint32_t e = ctx->tile_events[k];
+                splat_event_rect(*ctx, e, std::max(ctx->x_min[e], tile_x0),
+                                 std::min(ctx->x_max[e], tile_x1), std::max(ctx->y_min[e], tile_y0),
+                                 std::min(ctx->y_max[e], tile_y1), damage_map, occlusion_map,
+                                 height_map, cfg);
             }
         }
     }
@@ -115,4 +497,3 @@ void splat_apply(SplatContext* ctx, uint8_t* damage_map, uint8_t* occlusion_map,
 void splat_destroy(SplatContext* ctx) {
     delete ctx;
 }
-
@@ -0,0 +1,78 @@
+/**
+ * @file test_attenuation.cpp
+ * @brief Exhaustive check of the fixed-point height attenuation.
+ *
+ * Compares HeightAttenuation, scalar and (when built) AVX-512, with the
+ * baseline's float expression for every damage in [0, MAX_DAMAGE] and every
+ * u8 height, and checks that no event can add more than MAX_DAMAGE. Exits
+ * non-zero on the first mismatch.
+ *
+ * Usage:
+ *   make attenuation_test
+ */
+
+#include <cstdio>
+
+#include "submit_splat.cpp"
+
+namespace {
+
+int failures = 0;
+
+void expect(bool ok, const char* what, int damage, int h, int got, int want) {
+    if (!ok && failures++ < 10) {
+        std::printf("MISMATCH %s: damage=%d h=%d got=%d want=%d\n", what, damage, h, got, want);
+    }
+}
+
+}  // namespace
+
+int main() {
+    const HeightAttenuation attenuation;
+
+    // Reachable damage: bomb levels top out at round(intensity * falloff(0))
+    for (bool gaussian : {false, true}) {
+        const int top = DamageLevels(SplatContext::BOMB_INTENSITY, gaussian).exact(0.0f);
+        expect(top <= HeightAttenuation::MAX_DAMAGE, "bomb damage bound", top, -1, top,
+               HeightAttenuation::MAX_DAMAGE);
+    }
+    const int bullet = static_cast<int>(std::round(SplatContext::BULLET_INTENSITY));
+    expect(bullet <= HeightAttenuation::MAX_DAMAGE, "bullet damage bound", bullet, -1, bullet,
+           HeightAttenuation::MAX_DAMAGE);
+
+    for (int d = 0; d <= HeightAttenuation::MAX_DAMAGE; ++d) {
+        for (int h = 0; h < 256; ++h) {
+            const int want = HeightAttenuation::exact(d, static_cast<uint8_t>(h));
+            const int got = attenuation.apply(d, static_cast<uint8_t>(h));
+            expect(got == want, "scalar", d, h, got, want);
+        }
+    }
+
+#ifdef SPLAT_AVX512
+    const ScaleTable table(attenuation);
+    for (int d = 0; d <= HeightAttenuation::MAX_DAMAGE; ++d) {
+        for (int h0 = 0; h0 < 256; h0 += 16) {
+            // Mixed damage per lane, as bombs produce
+            int32_t damage[16], got[16];
+            for (int i = 0; i < 16; ++i) {
+                damage[i] = (d + i) % (HeightAttenuation::MAX_DAMAGE + 1);
+            }
+            const __m512i h = _mm512_add_epi32(_mm512_set1_epi32(h0),
+                                               _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                                                 10, 11, 12, 13, 14, 15));
+            _mm512_storeu_si512(got, attenuate_avx512(_mm512_loadu_si512(damage), h, table));
+            for (int i = 0; i < 16; ++i) {
+                const int want = HeightAttenuation::exact(damage[i], static_cast<uint8_t>(h0 + i));
+                expect(got[i] == want, "avx512", damage[i], h0 + i, got[i], want);
+            }
+        }
+    }
+#endif
+
+    if (failures) {
+        std::printf("%d mismatches\n", failures);
+        return 1;
+    }
+    std::printf("OK: %d damage values x 256 heights\n", HeightAttenuation::MAX_DAMAGE + 1);
+    return 0;
+}
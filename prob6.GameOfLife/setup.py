@@ -5,9 +5,10 @@ ext_modules = [
     Extension(
         'NG',
         ['src/NG.cpp'],
+        depends=['src/bitboard.h', 'src/hashlife.h', 'src/pattern_io.h', 'src/rule.h', 'src/tiled.h'],
         include_dirs=[pybind11.get_include(), pybind11.get_include(user=True)], 
         language='c++',
-        extra_compile_args=['-O3', '-Wall', '-fopenmp'],
+        extra_compile_args=['-O3', '-Wall', '-fopenmp', '-march=native'],
         extra_link_args=['-fopenmp'],
     ),
 ]
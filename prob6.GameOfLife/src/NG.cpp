@@ -1,32 +1,390 @@
+#include <algorithm>
+#include <memory>
+#include <string>
 #include <vector>
+#include <utility>
+#include <variant>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+
+#include "bitboard.h"
+#include "hashlife.h"
+#include "pattern_io.h"
+#include "tiled.h"
 
 namespace py = pybind11;
 
-std::vector<std::vector<int>> next_generation_cpp_ref(const std::vector<std::vector<int>>& grid) {
-    // not implemented
-    return std::vector<std::vector<int>>();
+typedef std::vector<std::vector<int>> Grid;
+// C-contiguous uint8 view; other dtypes / layouts are converted by NumPy, not per cell in Python
+typedef py::array_t<uint8_t, py::array::c_style | py::array::forcecast> Array;
+// Stepping engine: 64 x 64 tiles, only changed tiles and their neighbours are
+// recomputed, so sparse patterns do not pay for the empty space between them
+template <typename Rule>
+using Board = life::TiledBoard<Rule>;
+
+const char* const kDefaultRule = "B3/S23";
+
+// Same semantics as Next_Generation_Ref in conway.py: pad by one cell, step,
+// then trim to the bounding box of the live cells.
+Grid next_generation_cpp_ref(const Grid& grid, const std::string& rule) {
+    const life::RuleMask mask = life::parse_rule(rule);
+    if (grid.empty() || grid[0].empty()) {
+        return Grid();
+    }
+    const int height = grid.size(), width = grid[0].size();
+    auto at = [&](int y, int x) {
+        return (y >= 1 && y <= height && x >= 1 && x <= width) ? grid[y - 1][x - 1] : 0;
+    };
+    Grid next(height + 2, std::vector<int>(width + 2, 0));
+    int min_y = -1, max_y = -1, min_x = width + 2, max_x = -1;
+    for (int y = 0; y < height + 2; ++y) {
+        for (int x = 0; x < width + 2; ++x) {
+            int n = 0;
+            for (int i = -1; i <= 1; ++i) {
+                for (int j = -1; j <= 1; ++j) {
+                    if (i != 0 || j != 0) {
+                        n += at(y + i, x + j);
+                    }
+                }
+            }
+            next[y][x] = ((at(y, x) == 1 ? mask.survive : mask.birth) >> n) & 1;
+            if (next[y][x]) {
+                if (min_y == -1) min_y = y;
+                max_y = y;
+                min_x = std::min(min_x, x);
+                max_x = std::max(max_x, x);
+            }
+        }
+    }
+    if (min_y == -1) {
+        return Grid();
+    }
+    Grid trimmed;
+    for (int y = min_y; y <= max_y; ++y) {
+        trimmed.emplace_back(next[y].begin() + min_x, next[y].begin() + max_x + 1);
+    }
+    return trimmed;
+}
+
+template <typename Engine>
+static Engine load_grid(const Grid& grid, const typename Engine::rule_type& rule) {
+    Engine board(rule);
+    if (!grid.empty() && !grid[0].empty()) {
+        board.load(grid.size(), grid[0].size(), [&](int y, int x) { return grid[y][x]; });
+    }
+    return board;
+}
+
+template <typename Engine>
+static Engine load_array(const Array& grid, const typename Engine::rule_type& rule) {
+    Engine board(rule);
+    if (grid.size() == 0) {
+        return board;
+    }
+    if (grid.ndim() != 2) {
+        throw py::value_error("grid must be a 2D array");
+    }
+    const uint8_t* data = grid.data();
+    const py::ssize_t width = grid.shape(1);
+    board.load_rows(grid.shape(0), width, [&](int y) { return data + y * width; });
+    return board;
+}
+
+// Large dense soups go to the dense bitboard, whose run() advances several
+// generations per pass over memory. Smaller boards stay in cache anyway and
+// sparse ones are cheaper as tiles.
+const long long kDenseMinCells = 1LL << 22;
+const int kDenseMinPercent = 10;
+
+static bool is_dense(const Grid& grid) {
+    const long long cells = grid.empty() ? 0 : (long long)grid.size() * grid[0].size();
+    if (cells < kDenseMinCells) {
+        return false;
+    }
+    long long live = 0;
+    for (const auto& row : grid) {
+        for (int cell : row) {
+            live += cell != 0;
+        }
+    }
+    return live * 100 >= cells * kDenseMinPercent;
+}
+
+static bool is_dense(const Array& grid) {
+    if (grid.ndim() != 2 || (long long)grid.size() < kDenseMinCells) {
+        return false;
+    }
+    const uint8_t* data = grid.data();
+    long long live = 0;
+    for (py::ssize_t i = 0; i < grid.size(); i++) {
+        live += data[i] != 0;
+    }
+    return live * 100 >= (long long)grid.size() * kDenseMinPercent;
 }
 
-std::vector<std::vector<int>> expand_cpp(
-    const std::vector<std::vector<int>>& initial_grid,
-    int generations) {
-    
-    std::vector<std::vector<int>> current_grid = initial_grid;
+// Engine is Board or life::HashLife, both expose bounds() / store()
 
-    for (int g = 0; g < generations; ++g) {
-        current_grid = next_generation_cpp_ref(current_grid);
-        if (current_grid.empty()) {
-            break;
+// Trimmed live region; *y0 / *x0 receive its upper left corner in world coordinates
+template <typename Engine>
+static Grid store_grid(const Engine& board, long long* y0 = nullptr, long long* x0 = nullptr) {
+    long long top, left, bottom, right;
+    if (!board.bounds(&top, &left, &bottom, &right)) {
+        return Grid();
+    }
+    Grid grid(bottom - top + 1, std::vector<int>(right - left + 1, 0));
+    board.store(top, left, grid.size(), grid[0].size(), [&](int i) { return grid[i].data(); });
+    if (y0) *y0 = top;
+    if (x0) *x0 = left;
+    return grid;
+}
+
+template <typename Engine>
+static Array store_window(const Engine& board, long long y0, long long x0, int h, int w) {
+    Array out({h, w});
+    uint8_t* data = out.mutable_data();
+    board.store(y0, x0, h, w, [&](int i) { return data + (size_t)i * w; });
+    return out;
+}
+
+template <typename Engine>
+static Array store_array(const Engine& board) {
+    long long top, left, bottom, right;
+    if (!board.bounds(&top, &left, &bottom, &right)) {
+        return Array({0, 0});
+    }
+    return store_window(board, top, left, bottom - top + 1, right - left + 1);
+}
+
+// One generation, returns grid, (dy, dx) like Next_Generation_Ref
+std::pair<Grid, std::pair<long long, long long>> next_generation_cpp(const Grid& grid, const std::string& rule) {
+    return life::with_rule(life::parse_rule(rule), [&](auto r) {
+        auto board = load_grid<Board<decltype(r)>>(grid, r);
+        board.step();
+        long long dy = 0, dx = 0;
+        Grid next = store_grid(board, &dy, &dx);
+        return std::make_pair(next, std::make_pair(dy, dx));
+    });
+}
+
+// Long runs hand over to HashLife once the pattern is small enough for its
+// memoised jumps to pay off: sparse debris, gliders and oscillators. Dense
+// chaotic soups stay on the board engines, where HashLife finds little to reuse.
+const int kHashLifeMinGenerations = 4096;
+const int kHashLifeWarmup = 512;  // generations before deciding
+const long long kHashLifeMaxPopulation = 2048;
+
+// Run `generations` generations on the board; returns a HashLife engine that
+// holds the result instead if the run was handed over, nullptr otherwise
+template <typename Engine>
+using HashLifeFor = life::HashLife<typename Engine::rule_type>;
+
+template <typename Engine>
+static std::unique_ptr<HashLifeFor<Engine>> run(Engine& board, int generations) {
+    if (generations >= kHashLifeMinGenerations) {
+        if (!board.run(kHashLifeWarmup)) {
+            return nullptr;
+        }
+        generations -= kHashLifeWarmup;
+        if (board.population() <= kHashLifeMaxPopulation) {
+            std::unique_ptr<HashLifeFor<Engine>> hashlife(new HashLifeFor<Engine>(board.rule()));
+            hashlife->load(board);
+            hashlife->run(generations);
+            return hashlife;
         }
     }
+    board.run(generations);
+    return nullptr;
+}
+
+template <typename Engine>
+static Grid expand_grid(const Grid& initial_grid, int generations, const typename Engine::rule_type& rule) {
+    Engine board = load_grid<Engine>(initial_grid, rule);
+    std::unique_ptr<HashLifeFor<Engine>> hashlife = run(board, generations);
+    return hashlife ? store_grid(*hashlife) : store_grid(board);
+}
+
+template <typename Engine>
+static Array expand_array(const Array& initial_grid, int generations, const typename Engine::rule_type& rule) {
+    Engine board = load_array<Engine>(initial_grid, rule);
+    std::unique_ptr<HashLifeFor<Engine>> hashlife;
+    {
+        py::gil_scoped_release release;
+        hashlife = run(board, generations);
+    }
+    return hashlife ? store_array(*hashlife) : store_array(board);
+}
+
+// The rule string picks the kernel once, up front: every engine is compiled
+// per rule type (see life::with_rule), so the inner loops never test the rule
+Grid expand_cpp(const Grid& initial_grid, int generations, const std::string& rule) {
+    const life::RuleMask mask = life::parse_rule(rule);
+    const bool dense = is_dense(initial_grid);
+    return life::with_rule(mask, [&](auto r) {
+        typedef decltype(r) Rule;
+        return dense ? expand_grid<life::BitBoard<Rule>>(initial_grid, generations, r)
+                     : expand_grid<Board<Rule>>(initial_grid, generations, r);
+    });
+}
+
+// Expand_Cpp on NumPy buffers: the input is packed straight from the array
+// memory and the trimmed result is written into a new uint8 array
+Array expand_np(const Array& initial_grid, int generations, const std::string& rule) {
+    const life::RuleMask mask = life::parse_rule(rule);
+    const bool dense = is_dense(initial_grid);
+    return life::with_rule(mask, [&](auto r) {
+        typedef decltype(r) Rule;
+        return dense ? expand_array<life::BitBoard<Rule>>(initial_grid, generations, r)
+                     : expand_array<Board<Rule>>(initial_grid, generations, r);
+    });
+}
 
-    return current_grid;
+// Read an RLE / Life 1.05 / Life 1.06 file into a trimmed grid. The runs are
+// packed straight into tiles, so only the live region is ever expanded.
+Grid read_pattern(const std::string& path) {
+    Board<life::Conway> board;
+    board.load_runs([&](auto put) { life::read_pattern(path, put); });
+    return store_grid(board);
 }
 
+// A board for each rule type life::with_rule can pick
+typedef std::variant<Board<life::Conway>, Board<life::HighLife>, Board<life::DayAndNight>, Board<life::MaskRule>>
+    AnyBoard;
+
+// Keeps the universe in C++ between calls, so callers such as the visualizer
+// only copy out the part they need
+class Universe {
+public:
+    Universe(const Array& grid, const std::string& rule) : generation_(0) {
+        board_ = life::with_rule(life::parse_rule(rule), [&](auto r) {
+            return AnyBoard(load_array<Board<decltype(r)>>(grid, r));
+        });
+    }
+    Universe(const Grid& grid, const std::string& rule) : generation_(0) {
+        board_ = life::with_rule(life::parse_rule(rule), [&](auto r) {
+            return AnyBoard(load_grid<Board<decltype(r)>>(grid, r));
+        });
+    }
+
+    // Pattern file, placed with its file coordinates as world coordinates
+    static Universe load(const std::string& path, const std::string& rule) {
+        Universe universe;
+        universe.board_ = life::with_rule(life::parse_rule(rule), [&](auto r) {
+            Board<decltype(r)> board(r);
+            board.load_runs([&](auto put) { life::read_pattern(path, put); });
+            return AnyBoard(std::move(board));
+        });
+        return universe;
+    }
+
+    // Live cells as RLE, the upper left corner of the bounding box at (0, 0)
+    void save(const std::string& path) const {
+        std::visit([&](const auto& board) { life::write_rle(path, board, rule()); }, board_);
+    }
+
+    // Advance up to `generations` generations, stopping early once the board
+    // no longer changes. Returns the number of generations that changed it.
+    int step(int generations) {
+        py::gil_scoped_release release;
+        return std::visit([&](auto& board) {
+            int changed = 0;
+            for (int g = 0; g < generations; ++g) {
+                ++generation_;
+                if (!board.step()) {
+                    break;
+                }
+                ++changed;
+            }
+            return changed;
+        }, board_);
+    }
+
+    // Advance exactly `generations` generations; still lifes and cycles are
+    // jumped over instead of stepped (see TiledBoard::run)
+    void run(long long generations) {
+        if (generations < 0) {
+            throw py::value_error("generations must be non-negative");
+        }
+        py::gil_scoped_release release;
+        std::visit([&](auto& board) { board.run(generations); }, board_);
+        generation_ += generations;
+    }
+
+    std::string rule() const {
+        return std::visit([](const auto& board) { return life::rule_string(board.rule().mask()); }, board_);
+    }
+    long long generation() const { return generation_; }
+    long long population() const {
+        return std::visit([](const auto& board) { return board.population(); }, board_);
+    }
+
+    // (y0, x0, y1, x1) of the live cells in world coordinates, None if empty
+    py::object bounds() const {
+        long long y0, x0, y1, x1;
+        if (!std::visit([&](const auto& board) { return board.bounds(&y0, &x0, &y1, &x1); }, board_)) {
+            return py::none();
+        }
+        return py::make_tuple(y0, x0, y1, x1);
+    }
+
+    Array grid() const {
+        return std::visit([](const auto& board) { return store_array(board); }, board_);
+    }
+
+    Array window(long long y0, long long x0, int height, int width) const {
+        if (height < 0 || width < 0) {
+            throw py::value_error("window size must be non-negative");
+        }
+        return std::visit([&](const auto& board) { return store_window(board, y0, x0, height, width); }, board_);
+    }
+
+private:
+    Universe() : generation_(0) {}
+
+    AnyBoard board_;
+    long long generation_;
+};
+
 PYBIND11_MODULE(NG, m) {
     m.def("Expand_Cpp", &expand_cpp,
-          "Simulate multiple generations of Conway's Game of Life and return all intermediate states",
-          py::arg("initial_grid"), py::arg("generations"));
-}
\ No newline at end of file
+          "Simulate multiple generations of a Life-like rule (B3/S23 by default) and return the final trimmed grid",
+          py::arg("initial_grid"), py::arg("generations"), py::arg("rule") = kDefaultRule);
+    m.def("Expand_Np", &expand_np,
+          "Expand_Cpp on a 2D uint8 NumPy array, returns the trimmed grid as a uint8 array",
+          py::arg("initial_grid"), py::arg("generations"), py::arg("rule") = kDefaultRule);
+    m.def("Next_Generation_Cpp", &next_generation_cpp,
+          "Advance one generation, return grid, (dy, dx) like Next_Generation_Ref",
+          py::arg("grid"), py::arg("rule") = kDefaultRule);
+    m.def("Next_Generation_Cpp_Ref", &next_generation_cpp_ref,
+          "Scalar reference for one generation, returns the trimmed grid",
+          py::arg("grid"), py::arg("rule") = kDefaultRule);
+    m.def("Read_Pattern", &read_pattern,
+          "Read an RLE, Life 1.05 or Life 1.06 file, return the trimmed grid",
+          py::arg("path"));
+
+    // Array first: pybind11 tries overloads without implicit conversion
+    // first, so ndarrays take the buffer path and lists the Grid path
+    py::class_<Universe>(m, "Universe")
+        .def(py::init<const Array&, const std::string&>(), py::arg("grid"), py::arg("rule") = kDefaultRule)
+        .def(py::init<const Grid&, const std::string&>(), py::arg("grid"), py::arg("rule") = kDefaultRule)
+        .def_static("load", &Universe::load,
+                    "Universe from an RLE, Life 1.05 or Life 1.06 file", py::arg("path"),
+                    py::arg("rule") = kDefaultRule)
+        .def("save", &Universe::save,
+             "Write the live cells as RLE, bounding box corner at (0, 0)", py::arg("path"))
+        .def("step", &Universe::step,
+             "Advance up to `generations` generations, return how many changed the board",
+             py::arg("generations") = 1)
+        .def("run", &Universe::run,
+             "Advance exactly `generations` generations, jumping over still lifes and cycles",
+             py::arg("generations"))
+        .def_property_readonly("rule", &Universe::rule)
+        .def_property_readonly("generation", &Universe::generation)
+        .def_property_readonly("population", &Universe::population)
+        .def("bounds", &Universe::bounds,
+             "(y0, x0, y1, x1) of the live cells in world coordinates, None if empty")
+        .def("grid", &Universe::grid, "Trimmed live region as a uint8 array")
+        .def("window", &Universe::window,
+             "uint8 array of the height x width window whose upper left cell is world (y0, x0)",
+             py::arg("y0"), py::arg("x0"), py::arg("height"), py::arg("width"));
+}
@@ -0,0 +1,331 @@
+// Engine throughput benchmark, without Python in the loop.
+//
+//   bench [-g generations] [-t 1,2,4,...] [-e naive,bitboard,tiled,hashlife]
+//         [-r repeats] [-R rule] [pattern files...]
+//
+// Every pattern (dat/*.rle by default) is run for the same number of
+// generations on each engine and thread count. One CSV row is printed per
+// run:
+//   pattern,engine,threads,generations,cells,seconds,cell_updates_per_s,peak_kb,population
+// cells is the area of the pattern's bounding box and cell_updates_per_s is
+// cells * generations / seconds, so rows are comparable across engines even
+// when an engine skips empty space or whole periods. seconds is the best of
+// the repeats and excludes loading. peak_kb is the growth of the peak
+// resident set while the engine ran: each run happens in a forked child, so
+// runs do not see each other's allocations. naive and hashlife are serial
+// and only run with the first thread count.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <glob.h>
+#include <omp.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bitboard.h"
+#include "hashlife.h"
+#include "pattern_io.h"
+#include "rule.h"
+#include "tiled.h"
+
+// Default pattern directory, set to the source tree's dat/ by CMake
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "dat"
+#endif
+
+namespace {
+
+// Byte per cell, the same algorithm as Next_Generation_Ref: pad the live
+// region by one cell, count all eight neighbours of every cell, trim
+class NaiveBoard {
+public:
+    explicit NaiveBoard(const life::RuleMask& rule) : rule_(rule), height_(0), width_(0) {}
+
+    template <typename Cell>
+    void load(int height, int width, Cell cell) {
+        height_ = height;
+        width_ = width;
+        cells_.assign((size_t)height * width, 0);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                cells_[(size_t)y * width + x] = cell(y, x) != 0;
+            }
+        }
+    }
+
+    void run(long long generations) {
+        for (long long g = 0; g < generations && height_ > 0; g++) {
+            step();
+        }
+    }
+
+    long long population() const {
+        long long n = 0;
+        for (uint8_t c : cells_) {
+            n += c;
+        }
+        return n;
+    }
+
+private:
+    void step() {
+        const int h = height_ + 2, w = width_ + 2;
+        auto at = [&](int y, int x) -> int {
+            return (y >= 1 && y <= height_ && x >= 1 && x <= width_) ? cells_[(size_t)(y - 1) * width_ + x - 1] : 0;
+        };
+        std::vector<uint8_t> next((size_t)h * w, 0);
+        int y0 = h, y1 = -1, x0 = w, x1 = -1;
+        for (int y = 0; y < h; y++) {
+            for (int x = 0; x < w; x++) {
+                int n = 0;
+                for (int i = -1; i <= 1; i++) {
+                    for (int j = -1; j <= 1; j++) {
+                        if (i != 0 || j != 0) {
+                            n += at(y + i, x + j);
+                        }
+                    }
+                }
+                const uint8_t alive = ((at(y, x) ? rule_.survive : rule_.birth) >> n) & 1;
+                next[(size_t)y * w + x] = alive;
+                if (alive) {
+                    y0 = std::min(y0, y), y1 = std::max(y1, y);
+                    x0 = std::min(x0, x), x1 = std::max(x1, x);
+                }
+            }
+        }
+        if (y1 < 0) {
+            height_ = width_ = 0;
+            cells_.clear();
+            return;
+        }
+        height_ = y1 - y0 + 1;
+        width_ = x1 - x0 + 1;
+        cells_.assign((size_t)height_ * width_, 0);
+        for (int y = 0; y < height_; y++) {
+            std::copy(next.begin() + (size_t)(y + y0) * w + x0, next.begin() + (size_t)(y + y0) * w + x1 + 1,
+                      cells_.begin() + (size_t)y * width_);
+        }
+    }
+
+    life::RuleMask rule_;
+    int height_, width_;
+    std::vector<uint8_t> cells_;
+};
+
+struct Pattern {
+    std::string name;
+    int height, width;
+    std::vector<uint8_t> cells;  // row-major 0 / 1
+};
+
+Pattern read(const std::string& path) {
+    life::TiledBoard<> board;
+    board.load_runs([&](auto put) { life::read_pattern(path, put); });
+    Pattern p;
+    p.name = path.substr(path.find_last_of('/') + 1);
+    p.height = p.width = 0;
+    long long y0, x0, y1, x1;
+    if (board.bounds(&y0, &x0, &y1, &x1)) {
+        p.height = y1 - y0 + 1;
+        p.width = x1 - x0 + 1;
+        p.cells.assign((size_t)p.height * p.width, 0);
+        board.store(y0, x0, p.height, p.width, [&](int i) { return p.cells.data() + (size_t)i * p.width; });
+    }
+    return p;
+}
+
+// Peak and current resident set of this process in kB, from /proc
+long long proc_status_kb(const char* key) {
+    FILE* f = fopen("/proc/self/status", "r");
+    if (!f) {
+        return 0;
+    }
+    char line[256];
+    long long kb = 0;
+    const size_t n = strlen(key);
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, key, n) == 0) {
+            kb = atoll(line + n);
+            break;
+        }
+    }
+    fclose(f);
+    return kb;
+}
+
+struct Result {
+    double seconds;
+    long long population;
+};
+
+// Load, run and time one engine; the best of `repeats` runs
+template <typename Rule>
+Result time_engine(const std::string& engine, const Pattern& p, const Rule& rule, int generations, int repeats) {
+    auto cell = [&](int y, int x) { return p.cells[(size_t)y * p.width + x]; };
+    Result best = {1e300, 0};
+    for (int k = 0; k < repeats; k++) {
+        double seconds = 0;
+        long long population = 0;
+        auto timed = [&](auto&& run) {
+            const auto t0 = std::chrono::steady_clock::now();
+            run();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        };
+        if (engine == "naive") {
+            NaiveBoard board(rule.mask());
+            board.load(p.height, p.width, cell);
+            timed([&] { board.run(generations); });
+            population = board.population();
+        } else if (engine == "bitboard") {
+            life::BitBoard<Rule> board(rule);
+            board.load(p.height, p.width, cell);
+            timed([&] { board.run(generations); });
+            population = board.population();
+        } else if (engine == "tiled") {
+            life::TiledBoard<Rule> board(rule);
+            board.load(p.height, p.width, cell);
+            timed([&] { board.run(generations); });
+            population = board.population();
+        } else {
+            life::TiledBoard<Rule> board(rule);
+            board.load(p.height, p.width, cell);
+            life::HashLife<Rule> hashlife(rule);
+            hashlife.load(board);
+            timed([&] { hashlife.run(generations); });
+            population = hashlife.population();
+        }
+        if (seconds < best.seconds) {
+            best = Result{seconds, population};
+        }
+    }
+    return best;
+}
+
+// Run in a forked child so the peak resident set belongs to this run alone.
+// The parent never starts an OpenMP team, so the child's runtime is fresh.
+void bench_one(const std::string& engine, const Pattern& p, const life::RuleMask& rule, int threads,
+               int generations, int repeats) {
+    fflush(stdout);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s / %s / %d threads failed\n", p.name.c_str(), engine.c_str(), threads);
+        }
+        return;
+    }
+    omp_set_num_threads(threads);
+    // The child inherits the parent's peak; "5" resets it to the current size
+    if (FILE* f = fopen("/proc/self/clear_refs", "w")) {
+        fputs("5", f);
+        fclose(f);
+    }
+    const long long base_kb = proc_status_kb("VmRSS:");
+    const Result r = life::with_rule(rule, [&](auto rule_type) {
+        return time_engine(engine, p, rule_type, generations, repeats);
+    });
+    const long long peak_kb = proc_status_kb("VmHWM:") - base_kb;
+    const long long cells = (long long)p.height * p.width;
+    printf("%s,%s,%d,%d,%lld,%.6f,%.4g,%lld,%lld\n", p.name.c_str(), engine.c_str(), threads, generations, cells,
+           r.seconds, r.seconds > 0 ? (double)cells * generations / r.seconds : 0.0, std::max(0LL, peak_kb),
+           r.population);
+    fflush(stdout);
+    _exit(0);
+}
+
+std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> out;
+    size_t start = 0;
+    while (start <= s.size()) {
+        const size_t comma = std::min(s.find(',', start), s.size());
+        if (comma > start) {
+            out.push_back(s.substr(start, comma - start));
+        }
+        start = comma + 1;
+    }
+    return out;
+}
+
+void usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [-g generations] [-t 1,2,4,...] [-e naive,bitboard,tiled,hashlife] [-r repeats] [-R rule] "
+            "[pattern files...]\n",
+            argv0);
+    exit(2);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int generations = 100, repeats = 3;
+    std::vector<std::string> engines = {"naive", "bitboard", "tiled", "hashlife"};
+    std::vector<int> threads;
+    std::string rule = "B3/S23";
+    int opt;
+    while ((opt = getopt(argc, argv, "g:t:e:r:R:h")) != -1) {
+        switch (opt) {
+            case 'g': generations = atoi(optarg); break;
+            case 't':
+                for (const std::string& t : split(optarg)) threads.push_back(atoi(t.c_str()));
+                break;
+            case 'e': engines = split(optarg); break;
+            case 'r': repeats = std::max(1, atoi(optarg)); break;
+            case 'R': rule = optarg; break;
+            default: usage(argv[0]);
+        }
+    }
+    if (threads.empty()) {
+        // Powers of two up to the core count
+        const int cores = std::max(1u, std::thread::hardware_concurrency());
+        for (int t = 1; t < cores; t *= 2) threads.push_back(t);
+        threads.push_back(cores);
+    }
+    std::vector<std::string> paths(argv + optind, argv + argc);
+    if (paths.empty()) {
+        glob_t g;
+        if (glob(BENCH_DATA_DIR "/*.rle", 0, nullptr, &g) == 0) {
+            paths.assign(g.gl_pathv, g.gl_pathv + g.gl_pathc);
+        }
+        globfree(&g);
+    }
+    for (const std::string& engine : engines) {
+        if (engine != "naive" && engine != "bitboard" && engine != "tiled" && engine != "hashlife") {
+            fprintf(stderr, "unknown engine %s\n", engine.c_str());
+            usage(argv[0]);
+        }
+    }
+    if (paths.empty() || threads.empty() || generations < 0) {
+        usage(argv[0]);
+    }
+
+    try {
+        const life::RuleMask mask = life::parse_rule(rule);
+        printf("pattern,engine,threads,generations,cells,seconds,cell_updates_per_s,peak_kb,population\n");
+        for (const std::string& path : paths) {
+            const Pattern p = read(path);
+            for (const std::string& engine : engines) {
+                const bool serial = engine == "naive" || engine == "hashlife";
+                for (size_t i = 0; i < (serial ? 1 : threads.size()); i++) {
+                    bench_one(engine, p, mask, threads[i], generations, repeats);
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
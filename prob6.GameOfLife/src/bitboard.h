@@ -0,0 +1,401 @@
+#pragma once
+// Bit-packed Game of Life engine, 64 cells per uint64_t word.
+//
+// Storage is a rows_ x stride_ word array. Row 0, the last row, word 0 and the
+// last word of every row are guards that always stay zero, so the kernel can
+// read one word / one row past the region it updates without bounds checks.
+// Bit b of word w in storage row r is the world cell
+//   (oy_ + r, ox_ + 64 * w + b).
+// The board grows (and re-centers) whenever live cells get close to the
+// guards, so the universe is effectively unbounded. The rule is a type from
+// rule.h, so each rule gets its own compiled kernel.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "rule.h"
+
+namespace life {
+
+// Free rows / words kept around the pattern after (re)allocation
+const int kRowMargin = 32;
+const int kWordMargin = 1;
+
+// run() advances kTimeBlock generations per pass: each band of kBandRows rows
+// is copied with kTimeBlock halo rows into a private buffer and stepped there,
+// so the board goes through memory once per kTimeBlock generations. The halo
+// must fit in the row margin and in one guard word.
+const int kTimeBlock = 8;
+const int kBandRows = 64;
+
+// Inclusive rectangle of storage rows [r0, r1] and words [w0, w1]
+struct Rect {
+    int r0, r1, w0, w1;
+    bool empty() const { return r0 > r1; }
+    static Rect none() { return Rect{1, 0, 1, 0}; }
+    Rect grown(int dr, int dw) const { return Rect{r0 - dr, r1 + dr, w0 - dw, w1 + dw}; }
+    Rect united(const Rect& o) const {
+        if (empty()) return o;
+        if (o.empty()) return *this;
+        return Rect{std::min(r0, o.r0), std::max(r1, o.r1), std::min(w0, o.w0), std::max(w1, o.w1)};
+    }
+};
+
+// One generation for words [w0, w1] of one row. up/mid/dn point at the rows
+// above, at and below the output row. With AVX2/AVX-512 the loop handles
+// 256/512 cells per operation.
+// Returns the OR of the new words; *diff accumulates the OR of new ^ old.
+template <typename Rule>
+inline uint64_t life_row(const Rule& rule, const uint64_t* up, const uint64_t* mid, const uint64_t* dn,
+                         uint64_t* out, int w0, int w1, uint64_t* diff) {
+    uint64_t any = 0, changed = 0;
+    #pragma omp simd reduction(| : any, changed)
+    for (int i = w0; i <= w1; i++) {
+        // West / east neighbours: shift by one cell, pulling in the edge bit of
+        // the adjacent word. Bit b is column b, so "west" is a left shift.
+        const uint64_t uc = up[i];
+        const uint64_t mc = mid[i];
+        const uint64_t dc = dn[i];
+        const uint64_t n = rule.template cells<uint64_t>(
+            (uc << 1) | (up[i - 1] >> 63), uc, (uc >> 1) | (up[i + 1] << 63),
+            (mc << 1) | (mid[i - 1] >> 63), mc, (mc >> 1) | (mid[i + 1] << 63),
+            (dc << 1) | (dn[i - 1] >> 63), dc, (dc >> 1) | (dn[i + 1] << 63));
+        out[i] = n;
+        any |= n;
+        changed |= n ^ mc;
+    }
+    *diff |= changed;
+    return any;
+}
+
+template <typename Rule = Conway>
+class BitBoard {
+public:
+    typedef Rule rule_type;
+
+    explicit BitBoard(const Rule& rule = Rule())
+        : rule_(rule), rows_(3), stride_(3), oy_(0), ox_(0), live_(Rect::none()), dirty_(Rect::none()) {
+        cur_.assign((size_t)rows_ * stride_, 0);
+        nxt_ = cur_;
+    }
+
+    // Load a height x width pattern whose upper left cell is world (0, 0).
+    // cell(y, x) returns non-zero for a live cell.
+    template <typename Cell>
+    void load(int height, int width, Cell cell) {
+        const int words = (width + 63) / 64;
+        allocate(height + 2 * kRowMargin + 2, words + 2 * kWordMargin + 2);
+        oy_ = -(kRowMargin + 1);
+        ox_ = -64LL * (kWordMargin + 1);
+        for (int y = 0; y < height; y++) {
+            uint64_t* row = cur_.data() + (size_t)(y + kRowMargin + 1) * stride_ + kWordMargin + 1;
+            for (int x = 0; x < width; x++) {
+                if (cell(y, x)) {
+                    row[x >> 6] |= uint64_t(1) << (x & 63);
+                }
+            }
+        }
+        live_ = scan_live(cur_, Rect{1, rows_ - 2, 1, stride_ - 2});
+    }
+
+    // Same as load(), but row(y) returns a pointer to `width` contiguous
+    // bytes (0 = dead), e.g. a row of a C-contiguous uint8 NumPy array.
+    template <typename Row>
+    void load_rows(int height, int width, Row row) {
+        const int words = (width + 63) / 64;
+        allocate(height + 2 * kRowMargin + 2, words + 2 * kWordMargin + 2);
+        oy_ = -(kRowMargin + 1);
+        ox_ = -64LL * (kWordMargin + 1);
+        for (int y = 0; y < height; y++) {
+            const uint8_t* src = row(y);
+            uint64_t* dst = cur_.data() + (size_t)(y + kRowMargin + 1) * stride_ + kWordMargin + 1;
+            for (int k = 0; k < words; k++) {
+                const int n = std::min(64, width - 64 * k);
+                uint64_t bits = 0;
+                for (int b = 0; b < n; b++) {
+                    bits |= uint64_t(src[64 * k + b] != 0) << b;
+                }
+                dst[k] = bits;
+            }
+        }
+        live_ = scan_live(cur_, Rect{1, rows_ - 2, 1, stride_ - 2});
+    }
+
+    // Write the h x w window whose upper left cell is world (y0, x0) as 0/1
+    // values; row(i) returns the (w element) destination for window row i.
+    template <typename Row>
+    void store(long long y0, long long x0, int h, int w, Row row) const {
+        for (int i = 0; i < h; i++) {
+            auto* dst = row(i);
+            const long long r = y0 + i - oy_;
+            const bool live_row = !live_.empty() && r >= live_.r0 && r <= live_.r1;
+            const uint64_t* src = cur_.data() + (size_t)(live_row ? r : 0) * stride_;
+            for (int j = 0; j < w; j++) {
+                const long long c = x0 + j - ox_;
+                const long long k = c >> 6;
+                bool alive = false;
+                if (live_row && k >= live_.w0 && k <= live_.w1) {
+                    alive = (src[k] >> (c & 63)) & 1;
+                }
+                dst[j] = alive;
+            }
+        }
+    }
+
+    // Advance one generation. Returns false if the board is unchanged (a still
+    // life, or empty). A period-1 spaceship, which B3/S23 does not have, would
+    // count as changed here although its trimmed grid stays the same.
+    bool step() {
+        if (live_.empty()) {
+            return false;
+        }
+        Rect need = live_.grown(1, 1);
+        if (need.r0 < 1 || need.r1 > rows_ - 2 || need.w0 < 1 || need.w1 > stride_ - 2) {
+            recenter();
+            need = live_.grown(1, 1);
+        }
+        // Also recompute whatever the target buffer still holds from two
+        // generations ago, which clears it without a separate pass.
+        const Rect work = need.united(dirty_);
+        uint64_t diff = 0;
+        Rect next = Rect::none();
+        for (int r = work.r0; r <= work.r1; r++) {
+            const uint64_t* mid = cur_.data() + (size_t)r * stride_;
+            uint64_t* out = nxt_.data() + (size_t)r * stride_;
+            if (life_row(rule_, mid - stride_, mid, mid + stride_, out, work.w0, work.w1, &diff)) {
+                extend(&next, r, out, work.w0, work.w1);
+            }
+        }
+        dirty_ = live_;
+        live_ = next;
+        cur_.swap(nxt_);
+        return diff != 0;
+    }
+
+    // Advance kTimeBlock generations in one pass over memory, bands of rows in
+    // parallel. Returns false if the board is the same as before.
+    bool step_block() {
+        if (live_.empty()) {
+            return false;
+        }
+        const int t = kTimeBlock;
+        Rect need = live_.grown(t, 1);
+        if (need.r0 < 1 || need.r1 > rows_ - 2 || need.w0 < 1 || need.w1 > stride_ - 2) {
+            recenter();
+            need = live_.grown(t, 1);
+        }
+        // Cells outside `need` stay dead for t generations: they are more
+        // than t rows / one word away from any live cell
+        const Rect work = need.united(dirty_);
+        const int width = work.w1 - work.w0 + 1;
+        const int stride = width + 2;
+        const int bands = (work.r1 - work.r0 + kBandRows) / kBandRows;
+        std::vector<Rect> boxes(bands, Rect::none());
+        uint64_t diff = 0;
+        #pragma omp parallel reduction(| : diff)
+        {
+            // Band rows plus t + 1 halo rows on each side, with a zero guard
+            // word at both ends of every row
+            std::vector<uint64_t> a((size_t)(kBandRows + 2 * t + 2) * stride, 0), b(a);
+            #pragma omp for schedule(static)
+            for (int band = 0; band < bands; band++) {
+                const int r0 = work.r0 + band * kBandRows;
+                const int r1 = std::min(work.r1, r0 + kBandRows - 1);
+                const int top = r0 - t - 1, n = r1 - r0 + 2 * t + 3;
+                for (int i = 0; i < n; i++) {
+                    uint64_t* dst = a.data() + (size_t)i * stride + 1;
+                    const int r = top + i;
+                    if (r >= live_.r0 && r <= live_.r1) {
+                        std::memcpy(dst, cur_.data() + (size_t)r * stride_ + work.w0, sizeof(uint64_t) * width);
+                    } else {
+                        std::fill(dst, dst + width, 0);
+                    }
+                }
+                // Generation g is valid on local rows [g, n - 1 - g]
+                for (int g = 1; g <= t; g++) {
+                    uint64_t unused = 0;
+                    for (int i = g; i <= n - 1 - g; i++) {
+                        const uint64_t* mid = a.data() + (size_t)i * stride;
+                        life_row(rule_, mid - stride, mid, mid + stride, b.data() + (size_t)i * stride, 1, width, &unused);
+                    }
+                    a.swap(b);
+                }
+                for (int r = r0; r <= r1; r++) {
+                    const uint64_t* src = a.data() + (size_t)(r - top) * stride + 1;
+                    const uint64_t* old = cur_.data() + (size_t)r * stride_ + work.w0;
+                    uint64_t* out = nxt_.data() + (size_t)r * stride_;
+                    uint64_t any = 0;
+                    for (int k = 0; k < width; k++) {
+                        out[work.w0 + k] = src[k];
+                        any |= src[k];
+                        diff |= src[k] ^ old[k];
+                    }
+                    if (any) {
+                        extend(&boxes[band], r, out, work.w0, work.w1);
+                    }
+                }
+            }
+        }
+        Rect next = Rect::none();
+        for (const Rect& box : boxes) {
+            next = next.united(box);
+        }
+        dirty_ = live_;
+        live_ = next;
+        cur_.swap(nxt_);
+        return diff != 0;
+    }
+
+    // Advance `generations` generations, a time block at a time. Returns
+    // false if the board has become a still life (or died out).
+    bool run(long long generations) {
+        while (generations >= kTimeBlock) {
+            generations -= kTimeBlock;
+            if (!step_block()) {
+                // Same board kTimeBlock generations apart: it repeats with a
+                // period dividing kTimeBlock, so whole blocks change nothing
+                generations %= kTimeBlock;
+                break;
+            }
+        }
+        for (; generations > 0; generations--) {
+            if (!step()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const Rule& rule() const { return rule_; }
+    bool empty() const { return live_.empty(); }
+
+    long long population() const {
+        long long n = 0;
+        for (int r = live_.r0; r <= live_.r1; r++) {
+            const uint64_t* row = cur_.data() + (size_t)r * stride_;
+            for (int w = live_.w0; w <= live_.w1; w++) {
+                n += __builtin_popcountll(row[w]);
+            }
+        }
+        return n;
+    }
+
+    // Cell-exact bounding box of the live cells in world coordinates,
+    // [y0, y1] x [x0, x1]. Returns false if the board is empty.
+    bool bounds(long long* y0, long long* x0, long long* y1, long long* x1) const {
+        if (live_.empty()) {
+            return false;
+        }
+        uint64_t first = 0, last = 0;
+        for (int r = live_.r0; r <= live_.r1; r++) {
+            const uint64_t* row = cur_.data() + (size_t)r * stride_;
+            first |= row[live_.w0];
+            last |= row[live_.w1];
+        }
+        *y0 = oy_ + live_.r0;
+        *y1 = oy_ + live_.r1;
+        *x0 = ox_ + 64LL * live_.w0 + __builtin_ctzll(first);
+        *x1 = ox_ + 64LL * live_.w1 + 63 - __builtin_clzll(last);
+        return true;
+    }
+
+    // Call put(y, x) for every live cell, coordinates relative to (y0, x0)
+    template <typename Put>
+    void for_each_live(long long y0, long long x0, Put put) const {
+        for (int r = live_.r0; r <= live_.r1; r++) {
+            const uint64_t* row = cur_.data() + (size_t)r * stride_;
+            for (int w = live_.w0; w <= live_.w1; w++) {
+                uint64_t bits = row[w];
+                while (bits) {
+                    const int b = __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    put(oy_ + r - y0, ox_ + 64LL * w + b - x0);
+                }
+            }
+        }
+    }
+
+    // Call f(y, x, bits) for every non-zero word; bit b is world cell (y, x + b)
+    template <typename F>
+    void for_each_word(F f) const {
+        for (int r = live_.r0; r <= live_.r1; r++) {
+            const uint64_t* row = cur_.data() + (size_t)r * stride_;
+            for (int w = live_.w0; w <= live_.w1; w++) {
+                if (row[w]) {
+                    f(oy_ + r, ox_ + 64LL * w, row[w]);
+                }
+            }
+        }
+    }
+
+private:
+    void allocate(int rows, int stride) {
+        rows_ = rows;
+        stride_ = stride;
+        cur_.assign((size_t)rows_ * stride_, 0);
+        nxt_.assign((size_t)rows_ * stride_, 0);
+        dirty_ = Rect::none();
+    }
+
+    // Copy the live rectangle into a fresh buffer with margins proportional to
+    // its size. This grows the board as the pattern spreads and shrinks it
+    // again once debris has died out.
+    void recenter() {
+        const int h = live_.r1 - live_.r0 + 1;
+        const int w = live_.w1 - live_.w0 + 1;
+        const int mr = std::max(kRowMargin, h / 2);
+        const int mw = std::max(kWordMargin, w / 2);
+        std::vector<uint64_t> old;
+        old.swap(cur_);
+        const int old_stride = stride_;
+        allocate(h + 2 * mr + 2, w + 2 * mw + 2);
+        for (int r = 0; r < h; r++) {
+            std::memcpy(cur_.data() + (size_t)(r + mr + 1) * stride_ + mw + 1,
+                        old.data() + (size_t)(r + live_.r0) * old_stride + live_.w0,
+                        sizeof(uint64_t) * w);
+        }
+        oy_ += live_.r0 - (mr + 1);
+        ox_ += 64LL * (live_.w0 - (mw + 1));
+        live_ = Rect{mr + 1, mr + h, mw + 1, mw + w};
+    }
+
+    // Grow *box by the non-zero words of row r
+    static void extend(Rect* box, int r, const uint64_t* row, int w0, int w1) {
+        int a = w0, b = w1;
+        while (!row[a]) a++;
+        while (!row[b]) b--;
+        if (box->empty()) {
+            *box = Rect{r, r, a, b};
+        } else {
+            box->r1 = r;
+            box->w0 = std::min(box->w0, a);
+            box->w1 = std::max(box->w1, b);
+        }
+    }
+
+    Rect scan_live(const std::vector<uint64_t>& buf, const Rect& area) const {
+        Rect box = Rect::none();
+        for (int r = area.r0; r <= area.r1; r++) {
+            const uint64_t* row = buf.data() + (size_t)r * stride_;
+            uint64_t any = 0;
+            for (int w = area.w0; w <= area.w1; w++) {
+                any |= row[w];
+            }
+            if (any) {
+                extend(&box, r, row, area.w0, area.w1);
+            }
+        }
+        return box;
+    }
+
+    Rule rule_;
+    int rows_, stride_;
+    long long oy_, ox_;
+    std::vector<uint64_t> cur_, nxt_;
+    Rect live_;   // words of cur_ that may be non-zero
+    Rect dirty_;  // words of nxt_ that may be non-zero
+};
+
+}  // namespace life
@@ -60,7 +60,15 @@ def Expand_Ref(grid, iter):
 
 #这里是你可以修改的区域
 import NG
-def Expand(grid, iter):
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+def Expand(grid, iter, rule="B3/S23"):
     # Implement your own version to calculate the final grid
-    # return NG.Expand_Cpp(grid, iter)
-    return Expand_Ref(grid, iter)
\ No newline at end of file
+    # rule: Life-like rule in B/S notation, e.g. "B36/S23" (HighLife)
+    if np is not None:
+        # pass the grid as a uint8 buffer, avoiding per-cell pybind11 list conversion
+        return NG.Expand_Np(np.asarray(grid, dtype=np.uint8), iter, rule).tolist()
+    return NG.Expand_Cpp(grid, iter, rule)
\ No newline at end of file
@@ -0,0 +1,492 @@
+#pragma once
+// HashLife: the universe is a quadtree of hash-consed nodes, so identical
+// sub-patterns (in space and in time) are stored and evolved only once.
+//
+// A level-k node covers 2^k x 2^k cells. Level 3 nodes are leaves holding an
+// 8x8 bitmap (bit 8 * r + c is row r, column c). succ(n, j) returns the
+// centred level k-1 node advanced 2^j generations (j <= k - 2) and is
+// memoised per node. Memory is bounded by a mark-sweep collector that runs
+// whenever the node table reaches its cap; nodes held by the recursion in
+// progress are pinned so collection is safe at any allocation.
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bitboard.h"
+
+namespace life {
+
+template <typename Rule = Conway>
+class HashLife {
+public:
+    // max_nodes: node count that triggers garbage collection (~32 bytes each)
+    explicit HashLife(const Rule& rule = Rule(), size_t max_nodes = size_t(1) << 24)
+        : rule_(rule), max_nodes_(std::max<size_t>(max_nodes, 1 << 12)), live_nodes_(0), root_(0), oy_(0), ox_(0),
+          generation_(0) {
+        nodes_.reserve(1 << 16);
+        nodes_.push_back(Node());  // id 0 is "none"
+        buckets_.assign(1 << 16, 0);
+        zero_.push_back(0);
+        zero_.resize(4, 0);
+        zero_[3] = leaf(0);
+        root_ = zero(4);
+    }
+
+    // Load cells from a BitBoard or TiledBoard, keeping its world coordinates.
+    // A board's words need not start on a leaf column (a tiled board's origin
+    // moves with a spaceship), so each byte is split across the two leaves it
+    // straddles.
+    template <typename Board>
+    void load(const Board& board) {
+        std::unordered_map<uint64_t, uint64_t> leaves;
+        board.for_each_word([&](long long y, long long x, uint64_t bits) {
+            const long long by = floor_div(y, 8), bx = floor_div(x, 8);
+            const int row = 8 * (int)(y - 8 * by), shift = (int)(x - 8 * bx);
+            for (int k = 0; k < 8; k++) {
+                const uint64_t byte = (bits >> (8 * k)) & 0xff;
+                if (byte) {
+                    leaves[block_key(by, bx + k)] |= ((byte << shift) & 0xff) << row;
+                    if (byte >> (8 - shift)) {
+                        leaves[block_key(by, bx + k + 1)] |= (byte >> (8 - shift)) << row;
+                    }
+                }
+            }
+        });
+        build(leaves);
+        generation_ = 0;
+    }
+
+    // Advance exactly `generations` generations
+    void run(unsigned long long generations) {
+        for (int j = 63; j >= 0; j--) {
+            if ((generations >> j) & 1) {
+                step_pow2(j);
+            }
+        }
+    }
+
+    unsigned long long generation() const { return generation_; }
+    size_t node_count() const { return live_nodes_; }
+    bool empty() const { return root_ == zero(level(root_)); }
+
+    long long population() const {
+        std::unordered_map<uint32_t, long long> memo;
+        return population(root_, &memo);
+    }
+
+    // Cell-exact bounding box of the live cells in world coordinates
+    bool bounds(long long* y0, long long* x0, long long* y1, long long* x1) const {
+        if (empty()) {
+            return false;
+        }
+        *y0 = *x0 = (1LL << 62);
+        *y1 = *x1 = -(1LL << 62);
+        visit(root_, oy_, ox_, [&](long long y, long long x, uint64_t bits) {
+            for (int r = 0; r < 8; r++) {
+                const uint64_t row = (bits >> (8 * r)) & 0xff;
+                if (row) {
+                    *y0 = std::min(*y0, y + r);
+                    *y1 = std::max(*y1, y + r);
+                    *x0 = std::min(*x0, x + __builtin_ctzll(row));
+                    *x1 = std::max(*x1, x + 63 - __builtin_clzll(row));
+                }
+            }
+        });
+        return true;
+    }
+
+    // Same contract as BitBoard::store
+    template <typename Row>
+    void store(long long y0, long long x0, int h, int w, Row row) const {
+        for (int i = 0; i < h; i++) {
+            auto* dst = row(i);
+            for (int j = 0; j < w; j++) {
+                dst[j] = 0;
+            }
+        }
+        visit(root_, oy_, ox_, [&](long long y, long long x, uint64_t bits) {
+            while (bits) {
+                const int b = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                const long long cy = y + (b >> 3) - y0, cx = x + (b & 7) - x0;
+                if (cy >= 0 && cy < h && cx >= 0 && cx < w) {
+                    row(cy)[cx] = 1;
+                }
+            }
+        });
+    }
+
+private:
+    struct Node {
+        // Children; a leaf keeps its bitmap in (nw, ne)
+        uint32_t nw, ne, sw, se;
+        uint32_t next;    // hash chain / free list
+        uint32_t result;  // memoised successor
+        uint8_t level;
+        int8_t result_j;  // step exponent of result, -1 if none
+        uint8_t mark;
+        Node() : nw(0), ne(0), sw(0), se(0), next(0), result(0), level(0), result_j(-1), mark(0) {}
+    };
+
+    static long long floor_div(long long a, long long b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+    static uint64_t block_key(long long by, long long bx) {
+        return ((uint64_t)(uint32_t)by << 32) | (uint32_t)bx;
+    }
+    static uint64_t hash(uint64_t a, uint64_t b) {
+        uint64_t h = a * 0x9E3779B97F4A7C15ULL ^ (b + 0x632BE59BD9B4E019ULL + (a << 6) + (a >> 2));
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 29);
+    }
+    static uint64_t node_hash(const Node& n) {
+        return hash(((uint64_t)n.nw << 32 | n.ne) + n.level, (uint64_t)n.sw << 32 | n.se);
+    }
+
+    int level(uint32_t n) const { return nodes_[n].level; }
+    uint64_t bits(uint32_t n) const { return (uint64_t)nodes_[n].nw << 32 | nodes_[n].ne; }
+
+    uint32_t zero(int k) const { return zero_[k]; }
+    uint32_t zero(int k) {
+        while ((int)zero_.size() <= k) {
+            const uint32_t z = zero_.back();
+            zero_.push_back(join(z, z, z, z));
+        }
+        return zero_[k];
+    }
+
+    // Hash-consed constructors
+    uint32_t leaf(uint64_t b) { return intern(3, (uint32_t)(b >> 32), (uint32_t)b, 0, 0); }
+    uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+        return intern(nodes_[nw].level + 1, nw, ne, sw, se);
+    }
+
+    uint32_t intern(int k, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+        Node probe;
+        probe.level = k;
+        probe.nw = nw, probe.ne = ne, probe.sw = sw, probe.se = se;
+        const uint64_t h = node_hash(probe);
+        for (uint32_t i = buckets_[h & (buckets_.size() - 1)]; i; i = nodes_[i].next) {
+            const Node& n = nodes_[i];
+            if (n.level == k && n.nw == nw && n.ne == ne && n.sw == sw && n.se == se) {
+                return i;
+            }
+        }
+        if (free_.empty() && live_nodes_ + 1 >= max_nodes_) {
+            collect();
+        }
+        if (live_nodes_ + 1 > buckets_.size()) {
+            rehash(buckets_.size() * 2);
+        }
+        uint32_t id;
+        if (!free_.empty()) {
+            id = free_.back();
+            free_.pop_back();
+            nodes_[id] = probe;
+        } else {
+            id = nodes_.size();
+            nodes_.push_back(probe);
+        }
+        live_nodes_++;
+        uint32_t& head = buckets_[h & (buckets_.size() - 1)];
+        nodes_[id].next = head;
+        head = id;
+        return id;
+    }
+
+    void rehash(size_t size) {
+        buckets_.assign(size, 0);
+        for (uint32_t i = 1; i < nodes_.size(); i++) {
+            if (nodes_[i].level) {
+                uint32_t& head = buckets_[node_hash(nodes_[i]) & (size - 1)];
+                nodes_[i].next = head;
+                head = i;
+            }
+        }
+    }
+
+    // Mark everything reachable from the root, the zero nodes and the pinned
+    // nodes of the recursion in progress, then free the rest. Memoised results
+    // pointing at freed nodes are dropped.
+    void collect() {
+        std::vector<uint32_t> stack(pins_);
+        stack.push_back(root_);
+        stack.insert(stack.end(), zero_.begin() + 3, zero_.end());
+        while (!stack.empty()) {
+            const uint32_t n = stack.back();
+            stack.pop_back();
+            if (!n || nodes_[n].mark) {
+                continue;
+            }
+            nodes_[n].mark = 1;
+            if (nodes_[n].level > 3) {
+                stack.push_back(nodes_[n].nw);
+                stack.push_back(nodes_[n].ne);
+                stack.push_back(nodes_[n].sw);
+                stack.push_back(nodes_[n].se);
+            }
+        }
+        free_.clear();
+        live_nodes_ = 0;
+        for (uint32_t i = 1; i < nodes_.size(); i++) {
+            if (nodes_[i].mark) {
+                live_nodes_++;
+            } else {
+                nodes_[i].level = 0;
+                free_.push_back(i);
+            }
+        }
+        for (uint32_t i = 1; i < nodes_.size(); i++) {
+            Node& n = nodes_[i];
+            n.mark = 0;
+            if (n.result_j >= 0 && (!n.level || !nodes_[n.result].level)) {
+                n.result_j = -1;
+            }
+        }
+        // Free slots are handed out lowest id first
+        std::reverse(free_.begin(), free_.end());
+        rehash(buckets_.size());
+        // Collection could not free enough: let the table grow
+        if (live_nodes_ * 2 > max_nodes_) {
+            max_nodes_ = live_nodes_ * 2;
+        }
+    }
+
+    // Leaf made of rows 4..11, columns 4..11 of the 16x16 square of four leaves
+    uint64_t centre_bits(uint64_t nw, uint64_t ne, uint64_t sw, uint64_t se) const {
+        uint64_t out = 0;
+        for (int r = 0; r < 4; r++) {
+            out |= ((nw >> (8 * (r + 4) + 4)) & 0xf) << (8 * r);
+            out |= ((ne >> (8 * (r + 4))) & 0xf) << (8 * r + 4);
+            out |= ((sw >> (8 * r + 4)) & 0xf) << (8 * (r + 4));
+            out |= ((se >> (8 * r)) & 0xf) << (8 * (r + 4) + 4);
+        }
+        return out;
+    }
+
+    // Centred level k-1 node of a level k node
+    uint32_t centre(uint32_t n) {
+        const Node c = nodes_[n];
+        if (c.level == 4) {
+            return leaf(centre_bits(bits(c.nw), bits(c.ne), bits(c.sw), bits(c.se)));
+        }
+        return join(nodes_[c.nw].se, nodes_[c.ne].sw, nodes_[c.sw].ne, nodes_[c.se].nw);
+    }
+
+    // Level 4 base case: step the 16x16 square 2^j (<= 4) times with the
+    // bit-sliced kernel on 16 rows, return the centre 8x8.
+    uint32_t base(uint32_t n, int j) {
+        const Node c = nodes_[n];
+        const uint64_t nw = bits(c.nw), ne = bits(c.ne), sw = bits(c.sw), se = bits(c.se);
+        uint32_t row[18] = {0};
+        for (int r = 0; r < 8; r++) {
+            row[r + 1] = ((nw >> (8 * r)) & 0xff) | ((ne >> (8 * r)) & 0xff) << 8;
+            row[r + 9] = ((sw >> (8 * r)) & 0xff) | ((se >> (8 * r)) & 0xff) << 8;
+        }
+        for (int g = 0; g < (1 << j); g++) {
+            uint32_t next[18] = {0};
+            for (int r = 1; r <= 16; r++) {
+                const uint32_t u = row[r - 1], m = row[r], d = row[r + 1];
+                next[r] = rule_.template cells<uint32_t>(u << 1, u, u >> 1, m << 1, m, m >> 1,
+                                                         d << 1, d, d >> 1) & 0xffff;
+            }
+            std::copy(next, next + 18, row);
+        }
+        uint64_t out = 0;
+        for (int r = 0; r < 8; r++) {
+            out |= (uint64_t)((row[r + 5] >> 4) & 0xff) << (8 * r);
+        }
+        return leaf(out);
+    }
+
+    // Centred level k-1 node of n advanced 2^j generations, j <= k - 2
+    uint32_t succ(uint32_t n, int j) {
+        const int k = level(n);
+        if (n == zero(k)) {
+            return zero(k - 1);
+        }
+        // Steps of 2^(k-2) or more all mean "full speed" at this level
+        j = std::min(j, k - 2);
+        if (nodes_[n].result_j == j) {
+            return nodes_[n].result;
+        }
+        const size_t pinned = pins_.size();
+        uint32_t r;
+        if (k == 4) {
+            r = base(n, j);
+        } else {
+            const Node c = nodes_[n];
+            const Node a = nodes_[c.nw], b = nodes_[c.ne], s = nodes_[c.sw], d = nodes_[c.se];
+            // The nine overlapping level k-1 squares
+            uint32_t sq[9] = {c.nw, 0, c.ne, 0, 0, 0, c.sw, 0, c.se};
+            sq[1] = pin(join(a.ne, b.nw, a.se, b.sw));
+            sq[3] = pin(join(a.sw, a.se, s.nw, s.ne));
+            sq[4] = pin(join(a.se, b.sw, s.ne, d.nw));
+            sq[5] = pin(join(b.sw, b.se, d.nw, d.ne));
+            sq[7] = pin(join(s.ne, d.nw, s.se, d.sw));
+            // Full speed: both halves of the step advance 2^(k-3); otherwise
+            // only the second half advances and the first just re-centres
+            const bool full = j == k - 2;
+            uint32_t t[9];
+            for (int i = 0; i < 9; i++) {
+                t[i] = pin(full ? succ(sq[i], j - 1) : centre(sq[i]));
+            }
+            const int j2 = full ? j - 1 : j;
+            const uint32_t q0 = pin(succ(pin(join(t[0], t[1], t[3], t[4])), j2));
+            const uint32_t q1 = pin(succ(pin(join(t[1], t[2], t[4], t[5])), j2));
+            const uint32_t q2 = pin(succ(pin(join(t[3], t[4], t[6], t[7])), j2));
+            const uint32_t q3 = pin(succ(pin(join(t[4], t[5], t[7], t[8])), j2));
+            r = join(q0, q1, q2, q3);
+        }
+        pins_.resize(pinned);
+        nodes_[n].result = r;
+        nodes_[n].result_j = j;
+        return r;
+    }
+
+    uint32_t pin(uint32_t n) {
+        pins_.push_back(n);
+        return n;
+    }
+
+    // Level k+1 node with n in the middle
+    uint32_t expand(uint32_t n) {
+        const Node c = nodes_[n];
+        const size_t pinned = pins_.size();
+        pin(n);
+        zero(c.level + 1);
+        const uint32_t z = zero(c.level - 1);
+        const uint32_t nw = pin(join(z, z, z, c.nw));
+        const uint32_t ne = pin(join(z, z, c.ne, z));
+        const uint32_t sw = pin(join(z, c.sw, z, z));
+        const uint32_t se = pin(join(c.se, z, z, z));
+        const uint32_t r = join(nw, ne, sw, se);
+        pins_.resize(pinned);
+        return r;
+    }
+
+    // True if everything live lies in the centre 2^(k-2) square of the root,
+    // which lets a 2^(k-3) step keep all of it inside the result
+    bool padded() {
+        const int k = level(root_);
+        if (k < 6) {
+            return false;
+        }
+        const Node c = nodes_[root_];
+        const Node a = nodes_[c.nw], b = nodes_[c.ne], s = nodes_[c.sw], d = nodes_[c.se];
+        const size_t pinned = pins_.size();
+        const uint32_t inner = pin(join(nodes_[a.se].se, nodes_[b.sw].sw, nodes_[s.ne].ne, nodes_[d.nw].nw));
+        const bool centred = expand(pin(expand(inner))) == root_;
+        pins_.resize(pinned);
+        return centred;
+    }
+
+    void step_pow2(int j) {
+        if (empty()) {
+            generation_ += 1ULL << j;
+            return;
+        }
+        while (level(root_) < j + 3 || !padded()) {
+            const int k = level(root_);
+            root_ = expand(root_);
+            oy_ -= 1LL << (k - 1);
+            ox_ -= 1LL << (k - 1);
+        }
+        const int k = level(root_);
+        root_ = succ(root_, j);
+        oy_ += 1LL << (k - 2);
+        ox_ += 1LL << (k - 2);
+        generation_ += 1ULL << j;
+    }
+
+    // Build the tree bottom-up from 8x8 leaves keyed by block coordinates
+    void build(const std::unordered_map<uint64_t, uint64_t>& blocks) {
+        pins_.clear();
+        if (blocks.empty()) {
+            root_ = zero(4);
+            oy_ = ox_ = 0;
+            return;
+        }
+        long long by0 = 1LL << 40, bx0 = 1LL << 40;
+        for (const auto& kv : blocks) {
+            by0 = std::min(by0, (long long)(int32_t)(kv.first >> 32));
+            bx0 = std::min(bx0, (long long)(int32_t)(uint32_t)kv.first);
+        }
+        std::unordered_map<uint64_t, uint32_t> level_nodes;
+        for (const auto& kv : blocks) {
+            const long long by = (int32_t)(kv.first >> 32) - by0, bx = (int32_t)(uint32_t)kv.first - bx0;
+            level_nodes[block_key(by, bx)] = pin(leaf(kv.second));
+        }
+        // The root is kept at level 4 or above so expand() never sees a leaf
+        int k = 3;
+        while (k < 4 || level_nodes.size() > 1 || level_nodes.begin()->first != 0) {
+            std::unordered_map<uint64_t, std::vector<uint32_t>> parents;
+            for (const auto& kv : level_nodes) {
+                const long long by = kv.first >> 32, bx = (uint32_t)kv.first;
+                std::vector<uint32_t>& q = parents[block_key(by >> 1, bx >> 1)];
+                if (q.empty()) {
+                    q.assign(4, zero(k));
+                }
+                q[(by & 1) * 2 + (bx & 1)] = kv.second;
+            }
+            level_nodes.clear();
+            for (const auto& kv : parents) {
+                level_nodes[kv.first] = pin(join(kv.second[0], kv.second[1], kv.second[2], kv.second[3]));
+            }
+            k++;
+        }
+        root_ = level_nodes.begin()->second;
+        zero(k);
+        pins_.clear();
+        oy_ = by0 * 8;
+        ox_ = bx0 * 8;
+    }
+
+    // Call f(y, x, bits) for every non-empty leaf with its world corner
+    template <typename F>
+    void visit(uint32_t n, long long y, long long x, F f) const {
+        const Node& c = nodes_[n];
+        if (n == zero_[c.level]) {
+            return;
+        }
+        if (c.level == 3) {
+            f(y, x, bits(n));
+            return;
+        }
+        const long long h = 1LL << (c.level - 1);
+        visit(c.nw, y, x, f);
+        visit(c.ne, y, x + h, f);
+        visit(c.sw, y + h, x, f);
+        visit(c.se, y + h, x + h, f);
+    }
+
+    long long population(uint32_t n, std::unordered_map<uint32_t, long long>* memo) const {
+        const Node& c = nodes_[n];
+        if (c.level == 3) {
+            return __builtin_popcountll(bits(n));
+        }
+        auto it = memo->find(n);
+        if (it != memo->end()) {
+            return it->second;
+        }
+        const long long p = population(c.nw, memo) + population(c.ne, memo) + population(c.sw, memo) +
+                            population(c.se, memo);
+        (*memo)[n] = p;
+        return p;
+    }
+
+    Rule rule_;
+    size_t max_nodes_;
+    size_t live_nodes_;
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> buckets_;
+    std::vector<uint32_t> free_;
+    std::vector<uint32_t> zero_;  // canonical empty node per level
+    std::vector<uint32_t> pins_;  // nodes held by the recursion in progress
+    uint32_t root_;
+    long long oy_, ox_;           // world coordinates of the root's upper left cell
+    unsigned long long generation_;
+};
+
+}  // namespace life
@@ -4,6 +4,8 @@ from conway import *
 
 from visualize import Expand_Visualize
 
+import NG
+
 def initialize_grid(height, width):
     return [[random.choice([0, 1]) for _ in range(width)] for _ in range(height)]
 
@@ -60,6 +62,22 @@ def read_rte_file(file_path):
             
     return grid
 
+def read_pattern_file(file_path):
+    # RLE / Life 1.05 / Life 1.06 parsed in C++, only the live region is expanded
+    grid = NG.Read_Pattern(file_path)
+    return grid if grid else [[0]]
+
+def expand_rule_ref(grid, iter, rule):
+    # Expand_Ref for rules other than B3/S23, stepping with the scalar C++ reference
+    generation = 0
+    while True:
+        prev_grid = grid
+        generation = generation + 1
+        grid = NG.Next_Generation_Cpp_Ref(grid, rule)
+        if generation >= iter or grid == prev_grid:
+            break
+    return grid
+
 def trim_grid(grid):
     if not grid or not any(any(row) for row in grid):
         return [[0]]
@@ -86,32 +104,36 @@ def main():
     parser = argparse.ArgumentParser(description="Conway's Game of Life simulation.")
     parser.add_argument('-V', '--visualize', action='store_true', help='Enable visualization.')
     parser.add_argument('-I', '--iter', type=int, default=100, help='Number of iterations.')
+    parser.add_argument('-R', '--rule', type=str, default='B3/S23', help='Life-like rule in B/S notation, e.g. B36/S23.')
     
     group = parser.add_mutually_exclusive_group(required=True)
-    group.add_argument('-F', '--file', type=str, help='Path to an RTE file to load the initial grid.')
+    group.add_argument('-F', '--file', type=str, help='Path to an RLE or Life 1.05 / 1.06 file to load the initial grid.')
     group.add_argument('-S', '--size', type=int, nargs=2, metavar=('HEIGHT', 'WIDTH'), help='Height and width for a random grid.')
 
     args = parser.parse_args()
 
     grid = []
     if args.file:
-        grid = read_rte_file(args.file)
+        grid = read_pattern_file(args.file)
     elif args.size:
         height, width = args.size
         grid = initialize_grid(height, width)
     
     if args.visualize:
         os.system("cls" if os.name == 'nt' else 'clear')
-        Expand_Visualize(grid, args.iter)
+        Expand_Visualize(grid, args.iter, args.rule)
         return
 
     grid_ref = grid
     start_Ref = time.perf_counter()
-    ans_Ref = Expand_Ref(grid_ref, args.iter)
+    if args.rule.upper() == 'B3/S23':
+        ans_Ref = Expand_Ref(grid_ref, args.iter)
+    else:
+        ans_Ref = expand_rule_ref(grid_ref, args.iter, args.rule)
     end_Ref = time.perf_counter()
     
     start = time.perf_counter()
-    ans = Expand(grid, args.iter)
+    ans = Expand(grid, args.iter, args.rule)
     end = time.perf_counter()
 
     trimmed_ans = trim_grid(ans)
@@ -0,0 +1,230 @@
+#pragma once
+// Pattern files: RLE, Life 1.05 and Life 1.06 readers and an RLE writer.
+//
+// Readers never build a cell grid. They call put(y, x, n) for every run of n
+// live cells starting at world cell (y, x), so a board can pack the runs
+// straight into its own words (see TiledBoard::load_runs).
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace life {
+
+inline std::string read_file(const std::string& path) {
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    in.seekg(0, std::ios::end);
+    std::string data((size_t)in.tellg(), '\0');
+    in.seekg(0, std::ios::beg);
+    in.read(&data[0], data.size());
+    return data;
+}
+
+// Parse a signed decimal at p, advancing p; false if there is none
+inline bool parse_int(const char*& p, const char* end, long long* value) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p++ == '-';
+    }
+    if (p >= end || !isdigit((unsigned char)*p)) {
+        return false;
+    }
+    long long v = 0;
+    while (p < end && isdigit((unsigned char)*p)) {
+        v = v * 10 + (*p++ - '0');
+    }
+    *value = negative ? -v : v;
+    return true;
+}
+
+// RLE: '#' comment lines, an optional "x = .., y = .., rule = .." header, then
+// <count><tag> items up to '!'. 'b' / '.' are dead cells, '$' ends a row and
+// any other letter is a live cell (multi-state files are read as two-state).
+template <typename Put>
+void read_rle(const char* p, const char* end, Put put) {
+    bool header = false;
+    long long y = 0, x = 0, count = 0;
+    while (p < end) {
+        // Line start: comments and the header are whole lines
+        if (*p == '#' || (!header && *p == 'x')) {
+            header = header || *p == 'x';
+            while (p < end && *p != '\n') p++;
+            p++;
+            continue;
+        }
+        for (; p < end && *p != '\n'; p++) {
+            const char c = *p;
+            if (isdigit((unsigned char)c)) {
+                count = count * 10 + (c - '0');
+                continue;
+            }
+            const long long n = count ? count : 1;
+            count = 0;
+            if (c == 'b' || c == '.') {
+                x += n;
+            } else if (c == '$') {
+                y += n;
+                x = 0;
+            } else if (c == '!') {
+                return;
+            } else if (isalpha((unsigned char)c)) {
+                put(y, x, n);
+                x += n;
+            } else if (!isspace((unsigned char)c)) {
+                throw std::invalid_argument(std::string("unexpected character in RLE: ") + c);
+            }
+        }
+        header = true;  // the header, if any, must come first
+        p++;
+    }
+}
+
+// Life 1.05: "#P x y" starts a block of '.' / '*' rows at column x, row y
+template <typename Put>
+void read_life105(const char* p, const char* end, Put put) {
+    long long y = 0, x0 = 0;
+    while (p < end) {
+        const char* line = p;
+        while (p < end && *p != '\n') p++;
+        const char* eol = p++;
+        if (line < eol && *line == '#') {
+            if (eol - line > 2 && line[1] == 'P') {
+                const char* q = line + 2;
+                long long px, py;
+                if (!parse_int(q, eol, &px) || !parse_int(q, eol, &py)) {
+                    throw std::invalid_argument("bad #P line in Life 1.05 file");
+                }
+                x0 = px;
+                y = py;
+            }
+            continue;
+        }
+        for (const char* q = line; q < eol;) {
+            if (*q == '*') {
+                const char* run = q;
+                while (q < eol && *q == '*') q++;
+                put(y, x0 + (run - line), q - run);
+            } else {
+                q++;
+            }
+        }
+        y++;
+    }
+}
+
+// Life 1.06: one "x y" pair per live cell
+template <typename Put>
+void read_life106(const char* p, const char* end, Put put) {
+    while (p < end) {
+        const char* line = p;
+        while (p < end && *p != '\n') p++;
+        const char* eol = p++;
+        if (line == eol || *line == '#' || *line == '\r') {
+            continue;
+        }
+        const char* q = line;
+        long long x, y;
+        if (!parse_int(q, eol, &x) || !parse_int(q, eol, &y)) {
+            throw std::invalid_argument("bad cell line in Life 1.06 file");
+        }
+        put(y, x, 1);
+    }
+}
+
+// Pick the reader from the "#Life 1.0x" first line, RLE otherwise
+template <typename Put>
+void read_pattern(const std::string& path, Put put) {
+    const std::string data = read_file(path);
+    const char* p = data.data();
+    const char* end = p + data.size();
+    if (data.compare(0, 10, "#Life 1.05") == 0) {
+        read_life105(p, end, put);
+    } else if (data.compare(0, 10, "#Life 1.06") == 0) {
+        read_life106(p, end, put);
+    } else {
+        read_rle(p, end, put);
+    }
+}
+
+// Write the live cells of a board (anything with bounds() and
+// for_each_word()) as RLE, with the bounding box corner as (0, 0)
+template <typename Board>
+void write_rle(const std::string& path, const Board& board, const std::string& rule = "B3/S23") {
+    std::ofstream out(path.c_str(), std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("cannot open " + path);
+    }
+    long long y0 = 0, x0 = 0, y1 = -1, x1 = -1;
+    board.bounds(&y0, &x0, &y1, &x1);
+    out << "x = " << (x1 - x0 + 1) << ", y = " << (y1 - y0 + 1) << ", rule = " << rule << '\n';
+
+    struct Word {
+        long long y, x;
+        uint64_t bits;
+        bool operator<(const Word& o) const { return y != o.y ? y < o.y : x < o.x; }
+    };
+    std::vector<Word> words;
+    board.for_each_word([&](long long y, long long x, uint64_t bits) { words.push_back(Word{y, x, bits}); });
+    std::sort(words.begin(), words.end());
+
+    // Items are queued as (count, tag) and flushed into lines of at most 70
+    std::string line;
+    auto item = [&](long long n, char tag) {
+        char buf[32];
+        const int len = n > 1 ? snprintf(buf, sizeof(buf), "%lld%c", n, tag) : snprintf(buf, sizeof(buf), "%c", tag);
+        if (line.size() + len > 70) {
+            out << line << '\n';
+            line.clear();
+        }
+        line.append(buf, len);
+    };
+    long long row = y0, col = x0;  // next cell to be written
+    long long run_start = 0, run_end = 0;  // pending live run [start, end) on `row`
+    auto flush_run = [&]() {
+        if (run_end > run_start) {
+            if (run_start > col) item(run_start - col, 'b');
+            item(run_end - run_start, 'o');
+            col = run_end;
+        }
+        run_start = run_end = 0;
+    };
+    for (const Word& w : words) {
+        if (w.y != row) {
+            flush_run();
+            item(w.y - row, '$');
+            row = w.y;
+            col = x0;
+        }
+        // Runs of ones in the word; a run reaching bit 63 may go on in the
+        // next word, so runs are merged while they stay contiguous
+        uint64_t bits = w.bits;
+        while (bits) {
+            const int b = __builtin_ctzll(bits);
+            const uint64_t rest = ~(bits >> b);
+            const int len = rest ? __builtin_ctzll(rest) : 64;
+            const long long start = w.x + b;
+            if (start == run_end && run_end > run_start) {
+                run_end += len;
+            } else {
+                flush_run();
+                run_start = start;
+                run_end = start + len;
+            }
+            bits = b + len >= 64 ? 0 : bits & (~uint64_t(0) << (b + len));
+        }
+    }
+    flush_run();
+    item(1, '!');
+    out << line << '\n';
+}
+
+}  // namespace life
@@ -0,0 +1,184 @@
+#pragma once
+// Life-like rules in B/S notation and their bit-sliced kernels.
+//
+// A rule is a pair of 9-bit masks: bit n of `birth` is set if a dead cell
+// with n live neighbours is born, bit n of `survive` if a live one survives.
+// Conway's Life is B3/S23. Every engine is a template over a rule type whose
+// cells() computes the next state of all cells of a word at once:
+//
+// - StaticRule<Birth, Survive> fixes the masks at compile time, so the count
+//   comparisons fold into a branch-free boolean network for that rule, and
+//   Conway keeps its hand-reduced kernel life_cells();
+// - MaskRule holds the masks at run time, for rules without a StaticRule.
+//
+// B0 rules (cells born with no neighbours) would fill the infinite
+// background every other generation and are rejected by parse_rule().
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace life {
+
+// Bit-sliced neighbour count. Each bit position is an independent cell; the
+// count is s0 + 2 * (k0 + k1 + k2 + k3).
+template <typename W>
+struct Count {
+    W s0, k0, k1, k2, k3;
+};
+
+// Count from the west / east shifted copies (mw, me) of the cell's own row and
+// the three copies of the rows above (u*) and below (d*)
+template <typename W>
+inline Count<W> count_neighbours(W uw, W uc, W ue, W mw, W me, W dw, W dc, W de) {
+    // Row sums: up and down rows count 3 cells (full adder), the middle
+    // row counts only west and east (half adder).
+    const W ux = uw ^ uc;
+    const W us = ux ^ ue;
+    const W uk = (uw & uc) | (ux & ue);
+    const W dx = dw ^ dc;
+    const W ds = dx ^ de;
+    const W dk = (dw & dc) | (dx & de);
+    const W ms = mw ^ me;
+    const W mk = mw & me;
+
+    // Sum the three ones-bits: s0 is bit 0 of the count, c0 a carry of weight 2
+    const W sx = us ^ ds;
+    const W s0 = sx ^ ms;
+    const W c0 = (us & ds) | (sx & ms);
+    return Count<W>{s0, uk, dk, mk, c0};
+}
+
+// Next state of the cells of one word given the word itself (mc), its west /
+// east shifted copies (mw, me) and the same three for the rows above (u*) and
+// below (d*), under B3/S23.
+template <typename W>
+inline W life_cells(W uw, W uc, W ue, W mw, W mc, W me, W dw, W dc, W de) {
+    const Count<W> n = count_neighbours(uw, uc, ue, mw, me, dw, dc, de);
+    // Alive next generation iff the count is 3, or 2 and the cell is alive,
+    // i.e. exactly one of the four weight-2 bits is set and (s0 | alive).
+    const W px = n.k0 ^ n.k1;
+    const W py = n.k2 ^ n.k3;
+    const W odd = px ^ py;
+    const W two = (n.k0 & n.k1) | (n.k2 & n.k3) | (px & py);
+    return odd & ~two & (n.s0 | mc);
+}
+
+// Same for any rule given as masks. The four weight-2 bits are summed into
+// count bits b1, b2, b3 and each count in either mask is matched in full.
+// With constant masks the loop unrolls and the unused counts drop out.
+template <typename W>
+inline W rule_cells(unsigned birth, unsigned survive, W uw, W uc, W ue, W mw, W mc, W me, W dw, W dc, W de) {
+    const Count<W> n = count_neighbours(uw, uc, ue, mw, me, dw, dc, de);
+    const W px = n.k0 ^ n.k1;
+    const W py = n.k2 ^ n.k3;
+    const W a = n.k0 & n.k1, b = n.k2 & n.k3, c = px & py;
+    // At most two of a, b, c are set, and only a and b together (count >= 8)
+    const W b0 = n.s0, b1 = px ^ py, b2 = a ^ b ^ c, b3 = a & b;
+    W next = 0;
+    for (int k = 0; k <= 8; k++) {
+        const W born = (birth >> k) & 1 ? ~W(0) : W(0);
+        const W kept = (survive >> k) & 1 ? ~W(0) : W(0);
+        if (!born && !kept) {
+            continue;
+        }
+        const W is_k = k == 8 ? b3
+                              : ~b3 & (k & 1 ? b0 : ~b0) & (k & 2 ? b1 : ~b1) & (k & 4 ? b2 : ~b2);
+        next |= is_k & ((born & ~mc) | (kept & mc));
+    }
+    return next;
+}
+
+struct RuleMask {
+    unsigned birth, survive;
+    bool operator==(const RuleMask& o) const { return birth == o.birth && survive == o.survive; }
+};
+
+template <unsigned Birth, unsigned Survive>
+struct StaticRule {
+    RuleMask mask() const { return RuleMask{Birth, Survive}; }
+
+    template <typename W>
+    W cells(W uw, W uc, W ue, W mw, W mc, W me, W dw, W dc, W de) const {
+        if (Birth == 0x8 && Survive == 0xc) {
+            return life_cells<W>(uw, uc, ue, mw, mc, me, dw, dc, de);
+        }
+        return rule_cells<W>(Birth, Survive, uw, uc, ue, mw, mc, me, dw, dc, de);
+    }
+};
+
+// Rules with compiled kernels; anything else runs on MaskRule
+typedef StaticRule<0x8, 0xc> Conway;            // B3/S23
+typedef StaticRule<0x48, 0xc> HighLife;         // B36/S23
+typedef StaticRule<0x1c8, 0x1d8> DayAndNight;   // B3678/S34678
+
+struct MaskRule {
+    RuleMask m;
+
+    RuleMask mask() const { return m; }
+
+    template <typename W>
+    W cells(W uw, W uc, W ue, W mw, W mc, W me, W dw, W dc, W de) const {
+        return rule_cells<W>(m.birth, m.survive, uw, uc, ue, mw, mc, me, dw, dc, de);
+    }
+};
+
+// Parse "B3/S23" (either order, any case) or the older "23/3" survive/birth
+// form. Throws std::invalid_argument on anything else or on B0 rules.
+inline RuleMask parse_rule(const std::string& text) {
+    const size_t slash = text.find('/');
+    if (slash == std::string::npos || text.find('/', slash + 1) != std::string::npos) {
+        throw std::invalid_argument("bad rule: " + text);
+    }
+    const std::string parts[2] = {text.substr(0, slash), text.substr(slash + 1)};
+    RuleMask m = {0, 0};
+    unsigned* filled = nullptr;
+    for (int i = 0; i < 2; i++) {
+        const std::string& p = parts[i];
+        size_t k = 0;
+        unsigned* mask = i == 0 ? &m.survive : &m.birth;
+        if (!p.empty() && (p[0] == 'B' || p[0] == 'b')) {
+            mask = &m.birth, k = 1;
+        } else if (!p.empty() && (p[0] == 'S' || p[0] == 's')) {
+            mask = &m.survive, k = 1;
+        }
+        if (mask == filled) {
+            throw std::invalid_argument("bad rule: " + text);
+        }
+        filled = mask;
+        for (; k < p.size(); k++) {
+            if (p[k] < '0' || p[k] > '8') {
+                throw std::invalid_argument("bad rule: " + text);
+            }
+            *mask |= 1u << (p[k] - '0');
+        }
+    }
+    if (m.birth & 1) {
+        throw std::invalid_argument("B0 rules are not supported: " + text);
+    }
+    return m;
+}
+
+inline std::string rule_string(const RuleMask& m) {
+    std::string s = "B";
+    for (int k = 0; k <= 8; k++) {
+        if ((m.birth >> k) & 1) s += char('0' + k);
+    }
+    s += "/S";
+    for (int k = 0; k <= 8; k++) {
+        if ((m.survive >> k) & 1) s += char('0' + k);
+    }
+    return s;
+}
+
+// Call f with the rule object for m: a StaticRule when one matches, so the
+// kernel is specialised for it, MaskRule otherwise
+template <typename F>
+auto with_rule(const RuleMask& m, F f) {
+    if (m == Conway().mask()) return f(Conway());
+    if (m == HighLife().mask()) return f(HighLife());
+    if (m == DayAndNight().mask()) return f(DayAndNight());
+    return f(MaskRule{m});
+}
+
+}  // namespace life
@@ -0,0 +1,665 @@
+#pragma once
+// Sparse Game of Life engine: the universe is a hash map of 64 x 64 cell
+// tiles keyed by tile coordinates, one uint64_t per tile row.
+//
+// Bit b of row r of tile (ty, tx) is the world cell (64 * ty + r, 64 * tx + b).
+// Only tiles that changed in the previous generation and their eight
+// neighbours are recomputed; every other tile is known to be stable because
+// nothing it can see has changed. Tiles that die out are dropped, and new
+// ones are created where cells are born, so the universe grows without ever
+// reallocating a bounding box.
+//
+// run() also looks for cycles. Each generation is summarised by its
+// population and bounding box size; live tiles are counted per tile row and
+// column, so the box is found from the edge tiles alone. When
+// that summary repeats, a polynomial hash of the live cells is taken: every
+// tile caches its share, so only tiles that changed since are rehashed, and
+// the hash normalised to the bounding box corner is the same for all
+// translates of a pattern. A repeat confirmed over two periods (possibly
+// shifted, for spaceships) lets the remaining whole periods be skipped by
+// moving the board's origin.
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "bitboard.h"
+
+namespace life {
+
+const int kTileSize = 64;
+
+// Generations of history kept by run() when looking for cycles; periods up
+// to this long are found
+const int kCycleHistory = 1024;
+
+// Polynomial hash of a set of cells, the sum of A^y * B^x over the live cells
+// modulo the Mersenne prime 2^61 - 1. Moving a pattern by (dy, dx) multiplies
+// its hash by A^dy * B^dx.
+class CellHash {
+public:
+    static const CellHash& get() {
+        static const CellHash instance;
+        return instance;
+    }
+
+    static uint64_t add(uint64_t a, uint64_t b) { return reduce(a + b); }
+    static uint64_t sub(uint64_t a, uint64_t b) { return reduce(a + kPrime - b); }
+    static uint64_t mul(uint64_t a, uint64_t b) { return reduce128((unsigned __int128)a * b); }
+
+    // Hash of 64 rows of 64 cells whose upper left cell is (0, 0). The 64
+    // products fit a 128-bit sum, so only the total is reduced.
+    uint64_t block(const uint64_t* rows) const {
+        unsigned __int128 h = 0;
+        for (int r = 0; r < 64; r++) {
+            if (rows[r]) {
+                h += (unsigned __int128)pow_a_[r] * word(rows[r]);
+            }
+        }
+        return reduce128(h);
+    }
+
+    // A^y * B^x, for either sign of y and x
+    uint64_t at(long long y, long long x) const {
+        return mul(y >= 0 ? pow(kA, y) : pow(inv_a_, -y), x >= 0 ? pow(kB, x) : pow(inv_b_, -x));
+    }
+
+    // A^(64 * ty) * B^(64 * tx) for 0 <= ty, tx < 2^32, by table lookups
+    uint64_t tile(uint32_t ty, uint32_t tx) const {
+        uint64_t h = 1;
+        for (int k = 0; k < 4; k++) {
+            h = mul(h, mul(tile_a_[k][(ty >> (8 * k)) & 0xff], tile_b_[k][(tx >> (8 * k)) & 0xff]));
+        }
+        return h;
+    }
+
+private:
+    static const uint64_t kPrime = (uint64_t(1) << 61) - 1;
+    static const uint64_t kA = 0x1F3D5B79A2C4E6ULL % ((uint64_t(1) << 61) - 1);
+    static const uint64_t kB = 0x0BD1E995C6A4A793ULL % ((uint64_t(1) << 61) - 1);
+
+    CellHash() {
+        uint64_t pb[64];
+        pb[0] = pow_a_[0] = 1;
+        for (int i = 1; i < 64; i++) {
+            pb[i] = mul(pb[i - 1], kB);
+            pow_a_[i] = mul(pow_a_[i - 1], kA);
+        }
+        // Byte tables: byte_[k][v] is the hash of byte v at columns 8k .. 8k+7
+        for (int k = 0; k < 8; k++) {
+            for (int v = 0; v < 256; v++) {
+                uint64_t h = 0;
+                for (int b = 0; b < 8; b++) {
+                    if ((v >> b) & 1) {
+                        h = add(h, pb[8 * k + b]);
+                    }
+                }
+                byte_[k][v] = h;
+            }
+        }
+        inv_a_ = pow(kA, kPrime - 2);
+        inv_b_ = pow(kB, kPrime - 2);
+        for (int k = 0; k < 4; k++) {
+            for (int v = 0; v < 256; v++) {
+                tile_a_[k][v] = pow(kA, (unsigned long long)v << (8 * k + 6));
+                tile_b_[k][v] = pow(kB, (unsigned long long)v << (8 * k + 6));
+            }
+        }
+    }
+
+    static uint64_t reduce(uint64_t a) { return a >= kPrime ? a - kPrime : a; }
+
+    // 2^61 = 1 modulo the prime, so the 61-bit limbs of x just add up
+    static uint64_t reduce128(unsigned __int128 x) {
+        const uint64_t sum = (uint64_t)(x & kPrime) + (uint64_t)((x >> 61) & kPrime) + (uint64_t)(x >> 122);
+        return reduce((sum & kPrime) + (sum >> 61));
+    }
+
+    static uint64_t pow(uint64_t a, unsigned long long e) {
+        uint64_t r = 1;
+        for (; e; e >>= 1, a = mul(a, a)) {
+            if (e & 1) {
+                r = mul(r, a);
+            }
+        }
+        return r;
+    }
+
+    // Hash of one row word at row 0, bit b at column b
+    uint64_t word(uint64_t bits) const {
+        uint64_t h = 0;
+        for (int k = 0; k < 8; k++) {
+            h += byte_[k][(bits >> (8 * k)) & 0xff];
+        }
+        // Eight terms below 2^61 each: fold the sum once before reducing
+        return reduce((h & kPrime) + (h >> 61));
+    }
+
+    uint64_t byte_[8][256];
+    uint64_t pow_a_[64];
+    uint64_t tile_a_[4][256], tile_b_[4][256];
+    uint64_t inv_a_, inv_b_;
+};
+
+template <typename Rule = Conway>
+class TiledBoard {
+public:
+    typedef Rule rule_type;
+
+    explicit TiledBoard(const Rule& rule = Rule()) : rule_(rule), oy_(0), ox_(0), population_(0), zero_() {}
+
+    // Load a height x width pattern whose upper left cell is world (0, 0).
+    // cell(y, x) returns non-zero for a live cell.
+    template <typename Cell>
+    void load(int height, int width, Cell cell) {
+        clear();
+        for (int y = 0; y < height; y++) {
+            for (int x0 = 0; x0 < width; x0 += kTileSize) {
+                const int n = std::min(kTileSize, width - x0);
+                uint64_t bits = 0;
+                for (int b = 0; b < n; b++) {
+                    bits |= uint64_t(cell(y, x0 + b) != 0) << b;
+                }
+                put(y, x0, bits);
+            }
+        }
+        mark_all_changed();
+    }
+
+    // Same as load(), but row(y) returns a pointer to `width` contiguous
+    // bytes (0 = dead), e.g. a row of a C-contiguous uint8 NumPy array.
+    template <typename Row>
+    void load_rows(int height, int width, Row row) {
+        clear();
+        for (int y = 0; y < height; y++) {
+            const uint8_t* src = row(y);
+            for (int x0 = 0; x0 < width; x0 += kTileSize) {
+                const int n = std::min(kTileSize, width - x0);
+                uint64_t bits = 0;
+                for (int b = 0; b < n; b++) {
+                    bits |= uint64_t(src[x0 + b] != 0) << b;
+                }
+                put(y, x0, bits);
+            }
+        }
+        mark_all_changed();
+    }
+
+    // Load from a reader that calls put(y, x, n) for every run of n live
+    // cells starting at world cell (y, x), e.g. life::read_pattern. Runs are
+    // ORed straight into the tiles, no cell grid is built.
+    template <typename Reader>
+    void load_runs(Reader read) {
+        clear();
+        Tile* tile = nullptr;
+        uint64_t tile_key = 0;
+        read([&](long long y, long long x, long long n) {
+            const long long ty = floor_div(y, kTileSize);
+            const int r = (int)(y - ty * kTileSize);
+            while (n > 0) {
+                const long long tx = floor_div(x, kTileSize);
+                const int b = (int)(x - tx * kTileSize);
+                const int m = (int)std::min<long long>(n, kTileSize - b);
+                // Runs mostly continue in the tile of the previous one
+                const uint64_t k = key(ty, tx);
+                if (!tile || k != tile_key) {
+                    tile = &tiles_[k];
+                    tile_key = k;
+                }
+                tile->rows[r] |= (m == 64 ? ~uint64_t(0) : (uint64_t(1) << m) - 1) << b;
+                x += m;
+                n -= m;
+            }
+        });
+        mark_all_changed();
+    }
+
+    // Advance one generation. Returns false if the board is unchanged.
+    bool step() {
+        if (changed_.empty()) {
+            return false;
+        }
+        // Candidates: the tiles that changed and their neighbours. changed_
+        // is sorted, so widening each row by one tile and merging the row
+        // above / below gives the sorted candidate list in linear time.
+        std::vector<uint64_t> wide;
+        wide.reserve(changed_.size() * 3);
+        for (uint64_t k : changed_) {
+            const long long ty = key_y(k), tx = key_x(k);
+            long long x = tx - 1;
+            if (!wide.empty() && key_y(wide.back()) == ty) {
+                x = std::max(x, key_x(wide.back()) + 1);
+            }
+            for (; x <= tx + 1; x++) {
+                wide.push_back(key(ty, x));
+            }
+        }
+        std::vector<uint64_t> up(wide), dn(wide), both, work;
+        for (size_t i = 0; i < wide.size(); i++) {
+            up[i] -= kRowStep;
+            dn[i] += kRowStep;
+        }
+        both.reserve(wide.size() * 2);
+        std::merge(up.begin(), up.end(), wide.begin(), wide.end(), std::back_inserter(both));
+        work.reserve(wide.size() * 3);
+        std::merge(both.begin(), both.end(), dn.begin(), dn.end(), std::back_inserter(work));
+        work.erase(std::unique(work.begin(), work.end()), work.end());
+
+        // Candidates are independent: each reads the old generation only, so
+        // they are split across threads. A thread's candidates come in
+        // increasing order, which keeps the neighbour reuse along rows.
+        std::vector<Update> updates(work.size());
+        #pragma omp parallel
+        {
+            const uint64_t* around[9];
+            uint64_t prev = 0;
+            #pragma omp for schedule(static)
+            for (size_t i = 0; i < work.size(); i++) {
+                const uint64_t k = work[i];
+                const long long ty = key_y(k), tx = key_x(k);
+                if (prev && prev == key(ty, tx - 1)) {
+                    // The west neighbour was the previous candidate, so only
+                    // the east column is new
+                    for (int r = 0; r < 3; r++) {
+                        around[3 * r] = around[3 * r + 1];
+                        around[3 * r + 1] = around[3 * r + 2];
+                        around[3 * r + 2] = rows(ty + r - 1, tx + 1);
+                    }
+                } else {
+                    for (int j = 0; j < 9; j++) {
+                        around[j] = rows(ty + j / 3 - 1, tx + j % 3 - 1);
+                    }
+                }
+                prev = k;
+                Update& u = updates[i];
+                u.changed = false;
+                // A missing tile with nothing alive along the facing borders
+                // stays empty
+                if (around[4] == zero_.rows && !border_alive(around)) {
+                    continue;
+                }
+                uint64_t diff = 0;
+                u.alive = step_tile(around, u.tile.rows, &diff) != 0;
+                u.changed = diff != 0;
+                if (u.changed && u.alive) {
+                    summarize(&u.tile);
+                }
+            }
+        }
+        // Applied after the sweep so every tile saw the old generation
+        changed_.clear();
+        for (size_t i = 0; i < work.size(); i++) {
+            const Update& u = updates[i];
+            if (!u.changed) {
+                continue;
+            }
+            changed_.push_back(work[i]);
+            auto it = tiles_.find(work[i]);
+            if (it != tiles_.end()) {
+                population_ -= it->second.pop;
+            }
+            if (u.alive) {
+                population_ += u.tile.pop;
+                if (it != tiles_.end()) {
+                    it->second = u.tile;
+                } else {
+                    tiles_.emplace(work[i], u.tile);
+                    count_tile(work[i], +1);
+                }
+            } else if (it != tiles_.end()) {
+                tiles_.erase(it);
+                count_tile(work[i], -1);
+            }
+        }
+        return !changed_.empty();
+    }
+
+    // Advance `generations` generations. Returns false if the board has
+    // become a still life (or died out) on the way. Cycles of period up to
+    // kCycleHistory, with or without a shift, are jumped over once seen
+    // twice in a row.
+    bool run(long long generations) {
+        std::vector<Seen> seen(kCycleHistory);
+        // Latest generation in the window with a given summary / hash
+        std::unordered_map<uint64_t, long long> by_summary, by_hash;
+        for (long long g = 0; g <= generations; g++) {
+            if (g > 0 && !step()) {
+                return false;
+            }
+            Seen now = look();
+            const auto summary = by_summary.find(now.summary);
+            if (summary != by_summary.end()) {
+                now.hash = hash(now);
+                const auto match = by_hash.find(now.hash);
+                if (match != by_hash.end()) {
+                    const Seen& then = seen[match->second % kCycleHistory];
+                    now.period = g - match->second;
+                    now.dy = now.y0 - then.y0;
+                    now.dx = now.x0 - then.x0;
+                    if (then.period == now.period && then.dy == now.dy && then.dx == now.dx) {
+                        // Same cycle twice in a row: skip the whole periods
+                        // left, then finish without looking any further
+                        const long long p = now.period;
+                        const long long skip = (generations - g) / p;
+                        oy_ += skip * now.dy;
+                        ox_ += skip * now.dx;
+                        for (g += skip * p; g < generations; g++) {
+                            if (!step()) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
+                }
+            }
+            // Forget the generation that falls out of the window
+            Seen& slot = seen[g % kCycleHistory];
+            if (g >= kCycleHistory) {
+                forget(&by_summary, slot.summary, g - kCycleHistory);
+                if (slot.hashed) {
+                    forget(&by_hash, slot.hash, g - kCycleHistory);
+                }
+            }
+            slot = now;
+            by_summary[now.summary] = g;
+            if (now.hashed) {
+                by_hash[now.hash] = g;
+            }
+        }
+        return true;
+    }
+
+    const Rule& rule() const { return rule_; }
+    bool empty() const { return tiles_.empty(); }
+    size_t tile_count() const { return tiles_.size(); }
+
+    long long population() const { return population_; }
+
+    // Cell-exact bounding box of the live cells in world coordinates,
+    // [y0, y1] x [x0, x1]. Returns false if the board is empty.
+    bool bounds(long long* y0, long long* x0, long long* y1, long long* x1) const {
+        if (tiles_.empty()) {
+            return false;
+        }
+        // The extreme cells lie in the edge tile rows and columns. Those are
+        // looked up tile by tile unless that is more work than a full scan.
+        const long long ty0 = tile_rows_.begin()->first, ty1 = tile_rows_.rbegin()->first;
+        const long long tx0 = tile_cols_.begin()->first, tx1 = tile_cols_.rbegin()->first;
+        *y0 = *x0 = (1LL << 62);
+        *y1 = *x1 = -(1LL << 62);
+        auto extend = [&](uint64_t k, const Tile& t) {
+            const long long ty = key_y(k) * kTileSize, tx = key_x(k) * kTileSize;
+            *y0 = std::min(*y0, ty + t.r0);
+            *y1 = std::max(*y1, ty + t.r1);
+            *x0 = std::min(*x0, tx + __builtin_ctzll(t.cols));
+            *x1 = std::max(*x1, tx + 63 - __builtin_clzll(t.cols));
+        };
+        if ((unsigned long long)(ty1 - ty0 + tx1 - tx0 + 2) * 2 < tiles_.size()) {
+            auto visit = [&](long long ty, long long tx) {
+                auto it = tiles_.find(key(ty, tx));
+                if (it != tiles_.end()) {
+                    extend(it->first, it->second);
+                }
+            };
+            for (long long tx = tx0; tx <= tx1; tx++) {
+                visit(ty0, tx);
+                visit(ty1, tx);
+            }
+            for (long long ty = ty0; ty <= ty1; ty++) {
+                visit(ty, tx0);
+                visit(ty, tx1);
+            }
+        } else {
+            for (const auto& kv : tiles_) {
+                extend(kv.first, kv.second);
+            }
+        }
+        *y0 += oy_, *y1 += oy_;
+        *x0 += ox_, *x1 += ox_;
+        return true;
+    }
+
+    // Write the h x w window whose upper left cell is world (y0, x0) as 0/1
+    // values; row(i) returns the (w element) destination for window row i.
+    template <typename Row>
+    void store(long long y0, long long x0, int h, int w, Row row) const {
+        y0 -= oy_;
+        x0 -= ox_;
+        for (int i = 0; i < h; i++) {
+            auto* dst = row(i);
+            for (int j = 0; j < w; j++) {
+                dst[j] = 0;
+            }
+        }
+        for (const auto& kv : tiles_) {
+            const long long ty = key_y(kv.first) * kTileSize, tx = key_x(kv.first) * kTileSize;
+            if (ty + kTileSize <= y0 || ty >= y0 + h || tx + kTileSize <= x0 || tx >= x0 + w) {
+                continue;
+            }
+            for (int r = 0; r < kTileSize; r++) {
+                const long long i = ty + r - y0;
+                if (i < 0 || i >= h) {
+                    continue;
+                }
+                auto* dst = row(i);
+                uint64_t bits = kv.second.rows[r];
+                while (bits) {
+                    const int b = __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    const long long j = tx + b - x0;
+                    if (j >= 0 && j < w) {
+                        dst[j] = 1;
+                    }
+                }
+            }
+        }
+    }
+
+    // Call f(y, x, bits) for every non-zero word; bit b is world cell (y, x + b)
+    template <typename F>
+    void for_each_word(F f) const {
+        for (const auto& kv : tiles_) {
+            const long long ty = key_y(kv.first) * kTileSize, tx = key_x(kv.first) * kTileSize;
+            for (int r = 0; r < kTileSize; r++) {
+                if (kv.second.rows[r]) {
+                    f(oy_ + ty + r, ox_ + tx, kv.second.rows[r]);
+                }
+            }
+        }
+    }
+
+private:
+    struct Tile {
+        uint64_t rows[kTileSize];
+        // Summary of the rows, kept by summarize(): live row range, OR of
+        // the live rows, population, and the tile's share of the cell hash
+        // once it has been asked for
+        int r0, r1;
+        uint64_t cols;
+        int pop;
+        bool hashed;
+        uint64_t hash;
+    };
+    // One generation as seen by run(): a summary of population and bounding
+    // box size, the box corner (board coordinates, without the origin
+    // shift), the normalised cell hash if taken, and the period and shift
+    // of the earlier generation it repeats, if any
+    struct Seen {
+        uint64_t summary;
+        long long y0, x0;
+        bool hashed;
+        uint64_t hash;
+        long long period, dy, dx;
+    };
+    struct Update {
+        bool changed, alive;
+        Tile tile;
+    };
+
+    // Tile coordinates are kept as two biased 32-bit halves of the key, so
+    // keys sort row-major and the next row is key + kRowStep
+    static const long long kBias = 1LL << 31;
+    static const uint64_t kRowStep = uint64_t(1) << 32;
+    static uint64_t key(long long ty, long long tx) {
+        return ((uint64_t)(ty + kBias) << 32) | (uint64_t)(tx + kBias);
+    }
+    static long long key_y(uint64_t k) { return (long long)(k >> 32) - kBias; }
+    static long long key_x(uint64_t k) { return (long long)(uint32_t)k - kBias; }
+    static long long floor_div(long long a, long long b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+    const uint64_t* rows(long long ty, long long tx) const {
+        auto it = tiles_.find(key(ty, tx));
+        return it == tiles_.end() ? zero_.rows : it->second.rows;
+    }
+
+    static void summarize(Tile* t) {
+        int r0 = 0, r1 = kTileSize - 1;
+        while (r0 < r1 && !t->rows[r0]) r0++;
+        while (r1 > r0 && !t->rows[r1]) r1--;
+        uint64_t cols = 0;
+        int pop = 0;
+        for (int r = r0; r <= r1; r++) {
+            cols |= t->rows[r];
+            pop += __builtin_popcountll(t->rows[r]);
+        }
+        t->r0 = r0;
+        t->r1 = r1;
+        t->cols = cols;
+        t->pop = pop;
+        t->hashed = false;
+    }
+
+    Seen look() const {
+        Seen s = {0, 0, 0, false, 0, 0, 0, 0};
+        long long y1, x1;
+        if (bounds(&s.y0, &s.x0, &y1, &x1)) {
+            s.summary = hash_mix(hash_mix(population_, y1 - s.y0), x1 - s.x0);
+            s.y0 -= oy_;
+            s.x0 -= ox_;
+        }
+        return s;
+    }
+
+    // Cell hash of the board divided by the powers of the box corner in s.
+    // The biased tile coordinates scale every tile's share by the same
+    // constant, which does not matter for comparing generations.
+    uint64_t hash(Seen& s) {
+        const CellHash& h = CellHash::get();
+        uint64_t sum = 0;
+        for (auto& kv : tiles_) {
+            Tile& t = kv.second;
+            if (!t.hashed) {
+                t.hash = CellHash::mul(h.block(t.rows), h.tile((uint32_t)(kv.first >> 32), (uint32_t)kv.first));
+                t.hashed = true;
+            }
+            sum = CellHash::add(sum, t.hash);
+        }
+        s.hashed = true;
+        return CellHash::mul(sum, h.at(-s.y0, -s.x0));
+    }
+
+    static uint64_t hash_mix(uint64_t a, uint64_t b) {
+        uint64_t x = (a ^ (b + 0x9E3779B97F4A7C15ULL + (a << 6) + (a >> 2))) * 0xBF58476D1CE4E5B9ULL;
+        return x ^ (x >> 31);
+    }
+
+    static void forget(std::unordered_map<uint64_t, long long>* latest, uint64_t key, long long g) {
+        auto it = latest->find(key);
+        if (it != latest->end() && it->second == g) {
+            latest->erase(it);
+        }
+    }
+
+    // Count a tile that appeared (delta 1) or died (delta -1) in its tile
+    // row and column
+    void count_tile(uint64_t k, int delta) {
+        for (auto* line : {&tile_rows_, &tile_cols_}) {
+            auto it = line->emplace(line == &tile_rows_ ? key_y(k) : key_x(k), 0).first;
+            if ((it->second += delta) == 0) {
+                line->erase(it);
+            }
+        }
+    }
+
+    void clear() {
+        tiles_.clear();
+        changed_.clear();
+        tile_rows_.clear();
+        tile_cols_.clear();
+        oy_ = ox_ = 0;
+        population_ = 0;
+    }
+
+    // OR `bits` into world row y at columns [x0, x0 + 64), x0 tile aligned
+    void put(long long y, long long x0, uint64_t bits) {
+        if (bits) {
+            tiles_[key(y / kTileSize, x0 / kTileSize)].rows[y % kTileSize] |= bits;
+        }
+    }
+
+    void mark_all_changed() {
+        changed_.clear();
+        for (auto& kv : tiles_) {
+            summarize(&kv.second);
+            population_ += kv.second.pop;
+            count_tile(kv.first, +1);
+            changed_.push_back(kv.first);
+        }
+        std::sort(changed_.begin(), changed_.end());
+    }
+
+    // Whether any neighbour (row-major 3 x 3, centre missing) has a live cell
+    // adjacent to the centre tile
+    static bool border_alive(const uint64_t* const* t) {
+        uint64_t any = t[1][kTileSize - 1] | t[7][0];
+        any |= (t[0][kTileSize - 1] | t[6][0]) >> 63;
+        any |= (t[2][kTileSize - 1] | t[8][0]) & 1;
+        for (int r = 0; r < kTileSize; r++) {
+            any |= (t[3][r] >> 63) | (t[5][r] & 1);
+        }
+        return any != 0;
+    }
+
+    // Next generation of the centre of a 3 x 3 block of tiles (row-major).
+    // Returns the OR of the new rows; *diff receives the OR of new ^ old.
+    uint64_t step_tile(const uint64_t* const* t, uint64_t* out, uint64_t* diff) const {
+        // Rows -1 .. 64 of the west, centre and east columns
+        uint64_t w[kTileSize + 2], c[kTileSize + 2], e[kTileSize + 2];
+        w[0] = t[0][kTileSize - 1], c[0] = t[1][kTileSize - 1], e[0] = t[2][kTileSize - 1];
+        for (int r = 0; r < kTileSize; r++) {
+            w[r + 1] = t[3][r], c[r + 1] = t[4][r], e[r + 1] = t[5][r];
+        }
+        w[kTileSize + 1] = t[6][0], c[kTileSize + 1] = t[7][0], e[kTileSize + 1] = t[8][0];
+
+        uint64_t any = 0, changed = 0;
+        #pragma omp simd reduction(| : any, changed)
+        for (int r = 0; r < kTileSize; r++) {
+            const uint64_t uc = c[r], mc = c[r + 1], dc = c[r + 2];
+            const uint64_t n = rule_.template cells<uint64_t>(
+                (uc << 1) | (w[r] >> 63), uc, (uc >> 1) | (e[r] << 63),
+                (mc << 1) | (w[r + 1] >> 63), mc, (mc >> 1) | (e[r + 1] << 63),
+                (dc << 1) | (w[r + 2] >> 63), dc, (dc >> 1) | (e[r + 2] << 63));
+            out[r] = n;
+            any |= n;
+            changed |= n ^ mc;
+        }
+        *diff = changed;
+        return any;
+    }
+
+    Rule rule_;
+    long long oy_, ox_;  // world offset of the board after cycle jumps
+    long long population_;
+    std::unordered_map<uint64_t, Tile> tiles_;
+    std::vector<uint64_t> changed_;  // sorted keys of the tiles that changed (or died) last generation
+    // Number of live tiles in each tile row / column; they change only when
+    // tiles appear or die, and give bounds() the edge rows and columns
+    std::map<long long, int> tile_rows_, tile_cols_;
+    Tile zero_;
+};
+
+}  // namespace life
@@ -1,6 +1,7 @@
 import curses
 import asyncio
 from conway import Next_Generation_Ref
+import NG
 
 class World:
     _instance = None
@@ -16,6 +17,8 @@ class World:
         
         # calculated grid
         self.grid = None
+        # universe kept in C++, replaces self.grid when set
+        self.universe = None
 
         # singleton flag
         self.initialized = True
@@ -54,13 +57,20 @@ class World:
 
         display_grid = [['  ' for _ in range(display_width)] for _ in range(display_height)]
 
-        for r, row_data in enumerate(self.grid):
-            for c, cell in enumerate(row_data):
-                if cell:
-                    display_r = r + ul[0] + self.OFFSET
-                    display_c = c + ul[1] + self.OFFSET
-                    if 0 <= display_r < display_height and 0 <= display_c < display_width:
-                        display_grid[display_r][display_c] = '[]'
+        if self.universe is not None:
+            # only copy the visible window out of the C++ universe
+            window = self.universe.window(self.VORIGIN[0] - self.OFFSET, self.VORIGIN[1] - self.OFFSET,
+                                          max(display_height, 0), max(display_width, 0))
+            for display_r, display_c in zip(*window.nonzero()):
+                display_grid[display_r][display_c] = '[]'
+        else:
+            for r, row_data in enumerate(self.grid):
+                for c, cell in enumerate(row_data):
+                    if cell:
+                        display_r = r + ul[0] + self.OFFSET
+                        display_c = c + ul[1] + self.OFFSET
+                        if 0 <= display_r < display_height and 0 <= display_c < display_width:
+                            display_grid[display_r][display_c] = '[]'
         
         for i, row in enumerate(display_grid):
             if i >= max_y - 3:
@@ -119,6 +129,14 @@ class World:
 
     def evolve(self):
         """Evolves the grid to the next generation."""
+        if self.universe is not None:
+            changed = self.universe.step() > 0
+            bounds = self.universe.bounds()
+            if bounds is not None:
+                self.ul = (bounds[0], bounds[1])
+            self.generation += 1
+            return changed
+
         if self.grid is None:
             return False
 
@@ -210,8 +228,9 @@ class World:
 
 world = World()
 
-def Expand_Visualize(grid, iter_limit):
+def Expand_Visualize(grid, iter_limit, rule="B3/S23"):
     world.grid = grid
+    world.universe = NG.Universe(grid, rule)
 
     def run_async_loop(stdscr):
         return asyncio.run(world.game_loop_curses(stdscr, iter_limit))